@@ -33,7 +33,7 @@ int showFpsCounter = 0;
 int buttonScale = 5;
 int buttonSpacing = 10;
 int vibrateStrength = 1;
-int keyBinds[12] = {};
+int keyBinds[13] = {};
 
 std::string ndsPath = "", gbaPath = "";
 int ndsRomFd = -1, gbaRomFd = -1;
@@ -93,7 +93,8 @@ extern "C" JNIEXPORT jboolean JNICALL Java_com_hydra_noods_FileBrowser_loadSetti
         Setting("keyR",            &keyBinds[8],     false),
         Setting("keyL",            &keyBinds[9],     false),
         Setting("keyX",            &keyBinds[10],    false),
-        Setting("keyY",            &keyBinds[11],    false)
+        Setting("keyY",            &keyBinds[11],    false),
+        Setting("keyRewind",       &keyBinds[12],    false)
     };
 
     // Add the platform settings
@@ -101,7 +102,11 @@ extern "C" JNIEXPORT jboolean JNICALL Java_com_hydra_noods_FileBrowser_loadSetti
     Settings::add(platformSettings);
 
     // Load the settings
-    if (Settings::load(path + "/noods.ini"))
+    bool loaded = Settings::load(path + "/noods.ini");
+
+    // The framebuffer is only sized for 2x high-res 3D, so don't allow other scales
+    Settings::scale3D = 2;
+    if (loaded)
         return true;
 
     // If this is the first time, set the path settings based on the root storage path
@@ -283,6 +288,11 @@ extern "C" JNIEXPORT jint JNICALL Java_com_hydra_noods_SettingsMenu_getHighRes3D
     return Settings::highRes3D;
 }
 
+extern "C" JNIEXPORT jint JNICALL Java_com_hydra_noods_SettingsMenu_getRewind(JNIEnv* env, jobject obj)
+{
+    return Settings::rewind;
+}
+
 extern "C" JNIEXPORT jint JNICALL Java_com_hydra_noods_SettingsMenu_getScreenPosition(JNIEnv* env, jobject obj)
 {
     return ScreenLayout::screenPosition;
@@ -368,6 +378,11 @@ extern "C" JNIEXPORT void JNICALL Java_com_hydra_noods_SettingsMenu_setHighRes3D
     Settings::highRes3D = value;
 }
 
+extern "C" JNIEXPORT void JNICALL Java_com_hydra_noods_SettingsMenu_setRewind(JNIEnv* env, jobject obj, jint value)
+{
+    Settings::rewind = value;
+}
+
 extern "C" JNIEXPORT void JNICALL Java_com_hydra_noods_SettingsMenu_setScreenPosition(JNIEnv* env, jobject obj, jint value)
 {
     ScreenLayout::screenPosition = value;
@@ -448,6 +463,11 @@ extern "C" JNIEXPORT void JNICALL Java_com_hydra_noods_NooActivity_runFrame(JNIE
     core->runFrame();
 }
 
+extern "C" JNIEXPORT void JNICALL Java_com_hydra_noods_NooActivity_setRewinding(JNIEnv *env, jobject obj, jboolean value)
+{
+    core->rewindBuffer.setRewinding(value);
+}
+
 extern "C" JNIEXPORT void JNICALL Java_com_hydra_noods_NooActivity_writeSave(JNIEnv *env, jobject obj)
 {
     core->cartridgeNds.writeSave();
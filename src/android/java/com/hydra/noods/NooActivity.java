@@ -248,6 +248,13 @@ public class NooActivity extends AppCompatActivity
             }
         }
 
+        // Start rewinding if the rewind hotkey was pressed
+        if (keyCode == BindingsPreference.getKeyBind(12) - 1)
+        {
+            setRewinding(true);
+            return true;
+        }
+
         return super.onKeyDown(keyCode, event);
     }
 
@@ -264,6 +271,13 @@ public class NooActivity extends AppCompatActivity
             }
         }
 
+        // Stop rewinding if the rewind hotkey was released
+        if (keyCode == BindingsPreference.getKeyBind(12) - 1)
+        {
+            setRewinding(false);
+            return true;
+        }
+
         return super.onKeyUp(keyCode, event);
     }
 
@@ -453,6 +467,7 @@ public class NooActivity extends AppCompatActivity
     public static native int getFps();
     public static native boolean isGbaMode();
     public static native void runFrame();
+    public static native void setRewinding(boolean value);
     public static native void writeSave();
     public static native void restartCore();
     public static native void pressScreen(int x, int y);
@@ -54,6 +54,7 @@ public class SettingsMenu extends AppCompatActivity
         editor.putBoolean("threaded_2d", (getThreaded2D() == 0) ? false : true);
         editor.putString("threaded_3d", Integer.toString(getThreaded3D()));
         editor.putBoolean("high_res_3d", (getHighRes3D() == 0) ? false : true);
+        editor.putBoolean("rewind", (getRewind() == 0) ? false : true);
         editor.putString("screen_position", Integer.toString(getScreenPosition()));
         editor.putString("screen_rotation", Integer.toString(getScreenRotation()));
         editor.putString("screen_arrangement", Integer.toString(getScreenArrangement()));
@@ -83,6 +84,7 @@ public class SettingsMenu extends AppCompatActivity
         setThreaded2D(prefs.getBoolean("threaded_2d", true) ? 1 : 0);
         setThreaded3D(Integer.parseInt(prefs.getString("threaded_3d", "1")));
         setHighRes3D(prefs.getBoolean("high_res_3d", true) ? 1 : 0);
+        setRewind(prefs.getBoolean("rewind", false) ? 1 : 0);
         setScreenPosition(Integer.parseInt(prefs.getString("screen_position", "0")));
         setScreenRotation(Integer.parseInt(prefs.getString("screen_rotation", "0")));
         setScreenArrangement(Integer.parseInt(prefs.getString("screen_arrangement", "0")));
@@ -106,6 +108,7 @@ public class SettingsMenu extends AppCompatActivity
     public static native int getThreaded2D();
     public static native int getThreaded3D();
     public static native int getHighRes3D();
+    public static native int getRewind();
     public static native int getScreenPosition();
     public static native int getScreenRotation();
     public static native int getScreenArrangement();
@@ -123,6 +126,7 @@ public class SettingsMenu extends AppCompatActivity
     public static native void setThreaded2D(int value);
     public static native void setThreaded3D(int value);
     public static native void setHighRes3D(int value);
+    public static native void setRewind(int value);
     public static native void setScreenPosition(int value);
     public static native void setScreenRotation(int value);
     public static native void setScreenArrangement(int value);
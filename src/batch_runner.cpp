@@ -0,0 +1,148 @@
+/*
+    Copyright 2019-2023 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <thread>
+
+#include "batch_runner.h"
+#include "core.h"
+
+BatchRunner::BatchRunner(int threadCount):
+    threadCount(threadCount > 0 ? threadCount : std::max(1U, std::thread::hardware_concurrency())),
+    queues(this->threadCount)
+{
+}
+
+BatchRunner::~BatchRunner()
+{
+    // Clean up the cores
+    for (size_t i = 0; i < jobs.size(); i++)
+        delete jobs[i].core;
+}
+
+int BatchRunner::addCore(int frames, std::string ndsRom, std::string gbaRom, std::string ndsSave, std::string gbaSave)
+{
+    // Create a core that loads its files through the shared data, throwing the usual errors if it fails
+    // Every core uses ID 0 so it runs the same as a lone instance, which would give cores on the same ROM the same save
+    // Saves are only kept in memory unless paths are given, so jobs start blank and never touch the user's save files
+    BatchJob job;
+    job.core = new Core(ndsRom, gbaRom, ndsSave, gbaSave, 0, -1, -1, -1, -1, &sharedFiles, true);
+    job.frames = frames;
+    jobs.push_back(job);
+    return jobs.size() - 1;
+}
+
+void BatchRunner::run(BatchCallback callback)
+{
+    // Spread the unfinished jobs evenly across the worker queues
+    int count = 0;
+    for (size_t i = 0; i < jobs.size(); i++)
+    {
+        if (jobs[i].done < jobs[i].frames)
+            queues[count++ % threadCount].jobs.push_back(i);
+    }
+    remaining.store(count);
+
+    // Start the workers and wait for them to finish every job
+    std::vector<std::thread> threads;
+    for (int i = 0; i < threadCount; i++)
+        threads.push_back(std::thread(&BatchRunner::runWorker, this, i, std::ref(callback)));
+    for (int i = 0; i < threadCount; i++)
+        threads[i].join();
+}
+
+bool BatchRunner::takeJob(int thread, int &index)
+{
+    {
+        // Take the newest job from the thread's own queue, so it keeps running the same core while it can
+        std::lock_guard<std::mutex> guard(queues[thread].mutex);
+        if (!queues[thread].jobs.empty())
+        {
+            index = queues[thread].jobs.back();
+            queues[thread].jobs.pop_back();
+            return true;
+        }
+    }
+
+    // Steal the oldest job from another thread's queue if there's nothing left locally
+    for (int i = 1; i < threadCount; i++)
+    {
+        BatchQueue &queue = queues[(thread + i) % threadCount];
+        std::lock_guard<std::mutex> guard(queue.mutex);
+        if (!queue.jobs.empty())
+        {
+            index = queue.jobs.front();
+            queue.jobs.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void BatchRunner::runWorker(int thread, BatchCallback &callback)
+{
+    // Keep working while there are at least as many jobs as this thread's position
+    // A job only runs on one thread at a time, so extra threads would have nothing left to do
+    while (remaining.load() > thread)
+    {
+        uint32_t counter;
+        {
+            std::lock_guard<std::mutex> guard(waitMutex);
+            counter = waitCounter;
+        }
+
+        // Sleep until another thread puts a job back or finishes one if there's no job to take
+        int index;
+        if (!takeJob(thread, index))
+        {
+            std::unique_lock<std::mutex> lock(waitMutex);
+            waitCond.wait(lock, [&] { return waitCounter != counter; });
+            continue;
+        }
+
+        // Run a frame of the job; the queue locks make sure the next thread to take it sees the results
+        BatchJob &job = jobs[index];
+        job.core->runFrame();
+        job.done++;
+        if (callback)
+            callback(index, job.core, job.done);
+
+        // Put the job back in this thread's queue if it has frames left, or mark it as finished
+        bool finished = (job.done >= job.frames);
+        if (!finished)
+        {
+            std::lock_guard<std::mutex> guard(queues[thread].mutex);
+            queues[thread].jobs.push_back(index);
+        }
+        else
+        {
+            remaining--;
+        }
+
+        // Wake up a waiting thread to take the job, or all of them to check if they're still needed
+        {
+            std::lock_guard<std::mutex> guard(waitMutex);
+            waitCounter++;
+        }
+        if (finished)
+            waitCond.notify_all();
+        else
+            waitCond.notify_one();
+    }
+}
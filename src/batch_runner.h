@@ -0,0 +1,83 @@
+/*
+    Copyright 2019-2023 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "shared_files.h"
+
+class Core;
+
+// Called on a worker thread after a core finishes a frame, with the core's index and frames run so far
+typedef std::function<void(int index, Core *core, int frame)> BatchCallback;
+
+struct BatchJob
+{
+    Core *core;     // Core to run, owned by the runner
+    int frames;     // Total frames to run
+    int done = 0;   // Frames run so far
+};
+
+struct BatchQueue
+{
+    std::deque<int> jobs; // Indices of jobs waiting to run their next frame
+    std::mutex mutex;
+};
+
+class BatchRunner
+{
+    public:
+        BatchRunner(int threadCount = 0);
+        ~BatchRunner();
+
+        int addCore(int frames, std::string ndsRom = "", std::string gbaRom = "",
+                    std::string ndsSave = "", std::string gbaSave = "");
+        void run(BatchCallback callback = nullptr);
+
+        Core *getCore(int index) { return jobs[index].core; }
+        int getCoreCount() { return jobs.size(); }
+        int getThreadCount() { return threadCount; }
+
+    private:
+        int threadCount;
+        SharedFiles sharedFiles;
+        std::vector<BatchJob> jobs;
+
+        std::vector<BatchQueue> queues;
+        std::atomic<int> remaining;
+
+        // Threads without a job sleep until one is put back in a queue or one finishes
+        // The counter changes each time, so a thread can tell if it missed a signal while looking for jobs
+        std::mutex waitMutex;
+        std::condition_variable waitCond;
+        uint32_t waitCounter = 0;
+
+        bool takeJob(int thread, int &index);
+        void runWorker(int thread, BatchCallback &callback);
+};
+
+#endif // BATCH_RUNNER_H
@@ -0,0 +1,93 @@
+/*
+    Copyright 2019-2023 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include "benchmark.h"
+
+void Benchmark::setEnabled(bool value)
+{
+    // Toggle benchmarking, clearing any previous results when starting
+    if (value && !enabled)
+    {
+        for (int i = 0; i <= BENCH_TOTAL; i++)
+            frameTimes[i].clear();
+    }
+    enabled = value;
+    current = BENCH_CPU;
+}
+
+void Benchmark::startFrame()
+{
+    // Reset the section times and start timing the CPUs
+    for (int i = 0; i < BENCH_TOTAL; i++)
+        sectionTimes[i] = 0;
+    current = BENCH_CPU;
+    frameStart = sectionStart = std::chrono::steady_clock::now();
+}
+
+void Benchmark::endFrame()
+{
+    // Close off the current section and record the frame's times in nanoseconds
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    sectionTimes[current] += std::chrono::duration_cast<std::chrono::nanoseconds>(now - sectionStart).count();
+    for (int i = 0; i < BENCH_TOTAL; i++)
+        frameTimes[i].push_back(sectionTimes[i]);
+    frameTimes[BENCH_TOTAL].push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(now - frameStart).count());
+}
+
+void Benchmark::switchSection(BenchSection section)
+{
+    // Add the time since the last switch to the current section, and start timing the new one
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    sectionTimes[current] += std::chrono::duration_cast<std::chrono::nanoseconds>(now - sectionStart).count();
+    sectionStart = now;
+    current = section;
+}
+
+const char *Benchmark::getName(BenchSection section)
+{
+    // Get a readable name for a section
+    static const char *names[] = { "CPU", "Scheduler", "GPU 2D", "GPU 3D Geometry", "GPU 3D Renderer", "SPU", "Total" };
+    return names[section];
+}
+
+double Benchmark::getMean(BenchSection section)
+{
+    // Get the average time of a section across all frames, in milliseconds
+    std::vector<int64_t> &times = frameTimes[section];
+    if (times.empty()) return 0;
+    int64_t sum = 0;
+    for (size_t i = 0; i < times.size(); i++)
+        sum += times[i];
+    return sum / (times.size() * 1000000.0);
+}
+
+double Benchmark::getPercentile(BenchSection section, double percent)
+{
+    // Get the time of a section that the given percentage of frames are within, in milliseconds
+    // This uses the nearest-rank method, so results are always times that actually happened
+    std::vector<int64_t> times = frameTimes[section];
+    if (times.empty()) return 0;
+    size_t rank = (size_t)std::ceil(percent / 100 * times.size());
+    rank = std::min(times.size(), std::max<size_t>(rank, 1)) - 1;
+    std::nth_element(times.begin(), times.begin() + rank, times.end());
+    return times[rank] / 1000000.0;
+}
@@ -0,0 +1,81 @@
+/*
+    Copyright 2019-2023 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "defines.h"
+
+class Core;
+
+enum BenchSection
+{
+    BENCH_CPU = 0,
+    BENCH_SCHEDULER,
+    BENCH_GPU2D,
+    BENCH_GPU3D,
+    BENCH_RENDERER,
+    BENCH_SPU,
+    BENCH_TOTAL
+};
+
+class Benchmark
+{
+    public:
+        Benchmark(Core *core): core(core) {}
+
+        bool isEnabled() { return enabled; }
+        void setEnabled(bool value);
+
+        void startFrame();
+        void endFrame();
+        BenchSection setSection(BenchSection section);
+
+        static const char *getName(BenchSection section);
+        size_t getFrameCount() { return frameTimes[BENCH_TOTAL].size(); }
+        double getMean(BenchSection section);
+        double getPercentile(BenchSection section, double percent);
+
+    private:
+        Core *core;
+        bool enabled = false;
+
+        BenchSection current = BENCH_CPU;
+        std::chrono::steady_clock::time_point sectionStart;
+        std::chrono::steady_clock::time_point frameStart;
+        int64_t sectionTimes[BENCH_TOTAL] = {};
+        std::vector<int64_t> frameTimes[BENCH_TOTAL + 1];
+
+        void switchSection(BenchSection section);
+};
+
+FORCE_INLINE BenchSection Benchmark::setSection(BenchSection section)
+{
+    // Move timing to a different section, returning the old one so it can be restored
+    // This is called in hot paths, so only a flag check happens when not benchmarking
+    BenchSection last = current;
+    if (enabled) switchSection(section);
+    return last;
+}
+
+#endif // BENCHMARK_H
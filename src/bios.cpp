@@ -871,3 +871,15 @@ int Bios::swiUnknown(uint32_t **registers)
         LOG("Unknown ARM%d BIOS SWI: 0x%02X\n", (arm7 ? 7 : 9), comment);
     return 3;
 }
+
+void Bios::saveState(FILE *file)
+{
+    // Write state data to the file
+    fwrite(&waitFlags, sizeof(waitFlags), 1, file);
+}
+
+void Bios::loadState(FILE *file)
+{
+    // Read state data from the file
+    fread(&waitFlags, sizeof(waitFlags), 1, file);
+}
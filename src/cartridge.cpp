@@ -17,6 +17,7 @@
     along with NooDS. If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <cstring>
 
 #include "cartridge.h"
@@ -30,15 +31,17 @@ Cartridge::~Cartridge()
 
     // Free the ROM and save memory
     if (romFile) fclose(romFile);
-    if (rom)  delete[] rom;
+    if (rom && !romShared) delete[] rom;
     if (save) delete[] save;
 }
 
 bool Cartridge::setRom(std::string romPath, std::string savePath)
 {
     // Set the save path based on instance ID, or override if a path is provided
+    // Without a path, a core with memory saves has no save file, so it starts blank and never writes one
     std::string ext = core->id ? (".sv" + std::to_string(core->id + 1)) : ".sav";
-    this->savePath = (savePath == "") ? romPath.substr(0, romPath.rfind(".")) + ext : savePath;
+    if (savePath != "" || !core->memorySaves)
+        this->savePath = (savePath == "") ? romPath.substr(0, romPath.rfind(".")) + ext : savePath;
 
     // Load a ROM normally
     this->romPath = romPath;
@@ -55,15 +58,39 @@ bool Cartridge::setRom(int romFd, int saveFd)
 
 bool Cartridge::loadRom()
 {
-    // Attempt to open a ROM file
-    romFile = (romFd == -1) ? fopen(romPath.c_str(), "rb") : fdopen(dup(romFd), "rb");
-    if (!romFile) return false;
-    fseek(romFile, 0, SEEK_END);
-    romSize = ftell(romFile);
-    fseek(romFile, 0, SEEK_SET);
-
-    // Attempt to load the ROM's save into memory
-    if (FILE *saveFile = (saveFd == -1) ? fopen(savePath.c_str(), "rb") : fdopen(dup(saveFd), "rb"))
+    // Use the shared copy of the ROM if it can be shared, which leaves no file to load from
+    // Otherwise, load the ROM normally, which also handles missing files and large ROMs
+    const std::vector<uint8_t> *data = nullptr;
+    if (core->sharedFiles && romFd == -1 && (data = core->sharedFiles->get(romPath)))
+    {
+        romSize = data->size();
+
+        // Shared data is read-only, so a ROM that needs DLDI patches gets its own copy
+        if (Dldi::hasDriver(data->data(), romSize))
+        {
+            rom = new uint8_t[romSize];
+            memcpy(rom, data->data(), romSize);
+            core->dldi.patchRom(rom, 0, romSize);
+        }
+        else
+        {
+            rom = (uint8_t*)data->data();
+            romShared = true;
+        }
+    }
+    else
+    {
+        // Attempt to open a ROM file
+        romFile = (romFd == -1) ? fopen(romPath.c_str(), "rb") : fdopen(dup(romFd), "rb");
+        if (!romFile) return false;
+        fseek(romFile, 0, SEEK_END);
+        romSize = ftell(romFile);
+        fseek(romFile, 0, SEEK_SET);
+    }
+
+    // Attempt to load the ROM's save into memory, if it has a save file
+    FILE *saveFile = (saveFd != -1) ? fdopen(dup(saveFd), "rb") : (savePath != "") ? fopen(savePath.c_str(), "rb") : nullptr;
+    if (saveFile)
     {
         fseek(saveFile, 0, SEEK_END);
         saveSize = ftell(saveFile);
@@ -92,9 +119,9 @@ void Cartridge::loadRomSection(size_t offset, size_t size)
 
 void Cartridge::writeSave()
 {
-    // Update the save file if the data changed
+    // Update the save file if the data changed and there's a file to update
     mutex.lock();
-    if (saveDirty)
+    if (saveDirty && (saveFd != -1 || savePath != ""))
     {
         if (FILE *saveFile = (saveFd == -1) ? fopen(savePath.c_str(), "wb") : fdopen(dup(saveFd), "wb"))
         {
@@ -116,6 +143,13 @@ void Cartridge::writeSave()
 
 void Cartridge::trimRom()
 {
+    // Don't trim a shared ROM, since other cores use the same data and file
+    if (romShared)
+    {
+        LOG("Can't trim a ROM shared between cores\n");
+        return;
+    }
+
     // Starting from the end, reduce the ROM size until a non-filler word is found
     int newSize;
     for (newSize = romSize & ~3; newSize > 0; newSize -= 4)
@@ -171,6 +205,40 @@ void Cartridge::resizeSave(int newSize, bool dirty)
     mutex.unlock();
 }
 
+void Cartridge::saveState(FILE *file)
+{
+    // Write the save data to the file, since the game expects it to match the rest of the state
+    mutex.lock();
+    fwrite(&saveSize, sizeof(saveSize), 1, file);
+    if (saveSize > 0)
+        fwrite(save, sizeof(uint8_t), saveSize, file);
+    mutex.unlock();
+}
+
+void Cartridge::loadState(FILE *file)
+{
+    // Resize the save if needed, and read the save data from the file
+    int size;
+    fread(&size, sizeof(size), 1, file);
+    if (size >= 0 && size != saveSize)
+        resizeSave(size, false);
+    if (size > 0)
+    {
+        mutex.lock();
+        fread(save, sizeof(uint8_t), size, file);
+        saveDirty = true;
+        mutex.unlock();
+    }
+}
+
+bool Cartridge::checkState(FILE *file)
+{
+    // Check that the save size is unknown or one the cartridge supports, since the save is resized to it
+    int size;
+    if (fread(&size, sizeof(size), 1, file) != 1) return false;
+    return size == -1 || std::find(saveSizes.begin(), saveSizes.end(), size) != saveSizes.end();
+}
+
 bool CartridgeNds::loadRom()
 {
     // Set the valid NDS save sizes
@@ -189,11 +257,12 @@ bool CartridgeNds::loadRom()
     }
 
     // If the ROM is 512MB or smaller, try to load it into memory; otherwise fall back to file-based loading
+    // Shared ROMs are already fully in memory, so there's nothing to load for them
     if (!Cartridge::loadRom())
     {
         return false;
     }
-    else if (romSize <= 0x20000000) // 512MB
+    else if (romFile && romSize <= 0x20000000) // 512MB
     {
         try
         {
@@ -206,7 +275,7 @@ bool CartridgeNds::loadRom()
             loadRomSection(0, 0x5000);
         }
     }
-    else
+    else if (romFile)
     {
         loadRomSection(0, 0x5000);
     }
@@ -964,6 +1033,50 @@ uint32_t CartridgeNds::readRomDataIn(bool cpu)
     return 0xFFFFFFFF;
 }
 
+void CartridgeNds::saveState(FILE *file)
+{
+    // Write state data to the file
+    Cartridge::saveState(file);
+    fwrite(&cmdMode, sizeof(cmdMode), 1, file);
+    fwrite(encTable, sizeof(encTable), 1, file);
+    fwrite(encCode, sizeof(encCode), 1, file);
+    fwrite(romAddrReal, sizeof(romAddrReal), 1, file);
+    fwrite(romAddrVirt, sizeof(romAddrVirt), 1, file);
+    fwrite(blockSize, sizeof(blockSize), 1, file);
+    fwrite(readCount, sizeof(readCount), 1, file);
+    fwrite(wordCycles, sizeof(wordCycles), 1, file);
+    fwrite(encrypted, sizeof(encrypted), 1, file);
+    fwrite(auxCommand, sizeof(auxCommand), 1, file);
+    fwrite(auxAddress, sizeof(auxAddress), 1, file);
+    fwrite(auxWriteCount, sizeof(auxWriteCount), 1, file);
+    fwrite(auxSpiCnt, sizeof(auxSpiCnt), 1, file);
+    fwrite(auxSpiData, sizeof(auxSpiData), 1, file);
+    fwrite(romCtrl, sizeof(romCtrl), 1, file);
+    fwrite(romCmdOut, sizeof(romCmdOut), 1, file);
+}
+
+void CartridgeNds::loadState(FILE *file)
+{
+    // Read state data from the file
+    Cartridge::loadState(file);
+    fread(&cmdMode, sizeof(cmdMode), 1, file);
+    fread(encTable, sizeof(encTable), 1, file);
+    fread(encCode, sizeof(encCode), 1, file);
+    fread(romAddrReal, sizeof(romAddrReal), 1, file);
+    fread(romAddrVirt, sizeof(romAddrVirt), 1, file);
+    fread(blockSize, sizeof(blockSize), 1, file);
+    fread(readCount, sizeof(readCount), 1, file);
+    fread(wordCycles, sizeof(wordCycles), 1, file);
+    fread(encrypted, sizeof(encrypted), 1, file);
+    fread(auxCommand, sizeof(auxCommand), 1, file);
+    fread(auxAddress, sizeof(auxAddress), 1, file);
+    fread(auxWriteCount, sizeof(auxWriteCount), 1, file);
+    fread(auxSpiCnt, sizeof(auxSpiCnt), 1, file);
+    fread(auxSpiData, sizeof(auxSpiData), 1, file);
+    fread(romCtrl, sizeof(romCtrl), 1, file);
+    fread(romCmdOut, sizeof(romCmdOut), 1, file);
+}
+
 bool CartridgeGba::findString(std::string string)
 {
     // Scan a GBA ROM for a string and report if it was found
@@ -1000,11 +1113,14 @@ bool CartridgeGba::loadRom()
         saveSizes.push_back(0x20000); // FLASH 128KB
     }
 
-    // Load the ROM into memory
+    // Load the ROM into memory, unless it's shared and already there
     if (!Cartridge::loadRom()) return false;
-    loadRomSection(0, romSize);
-    fclose(romFile);
-    romFile = nullptr;
+    if (romFile)
+    {
+        loadRomSection(0, romSize);
+        fclose(romFile);
+        romFile = nullptr;
+    }
 
     // Calculate the mask for ROM mirroring
     if (romSize > 0xAC && rom[0xAC] == 'F') // NES classic
@@ -1261,3 +1377,29 @@ void CartridgeGba::sramWrite(uint32_t address, uint8_t value)
         }
     }
 }
+
+void CartridgeGba::saveState(FILE *file)
+{
+    // Write state data to the file
+    Cartridge::saveState(file);
+    fwrite(&eepromCount, sizeof(eepromCount), 1, file);
+    fwrite(&eepromCmd, sizeof(eepromCmd), 1, file);
+    fwrite(&eepromData, sizeof(eepromData), 1, file);
+    fwrite(&eepromDone, sizeof(eepromDone), 1, file);
+    fwrite(&flashCmd, sizeof(flashCmd), 1, file);
+    fwrite(&bankSwap, sizeof(bankSwap), 1, file);
+    fwrite(&flashErase, sizeof(flashErase), 1, file);
+}
+
+void CartridgeGba::loadState(FILE *file)
+{
+    // Read state data from the file
+    Cartridge::loadState(file);
+    fread(&eepromCount, sizeof(eepromCount), 1, file);
+    fread(&eepromCmd, sizeof(eepromCmd), 1, file);
+    fread(&eepromData, sizeof(eepromData), 1, file);
+    fread(&eepromDone, sizeof(eepromDone), 1, file);
+    fread(&flashCmd, sizeof(flashCmd), 1, file);
+    fread(&bankSwap, sizeof(bankSwap), 1, file);
+    fread(&flashErase, sizeof(flashErase), 1, file);
+}
@@ -21,6 +21,7 @@
 #define CARTRIDGE_H
 
 #include <cstdint>
+#include <cstdio>
 #include <mutex>
 #include <string>
 #include <vector>
@@ -44,6 +45,10 @@ class Cartridge
         Cartridge(Core *core): core(core) {}
         ~Cartridge();
 
+        void saveState(FILE *file);
+        void loadState(FILE *file);
+        bool checkState(FILE *file);
+
         bool setRom(std::string romPath, std::string savePath = "");
         bool setRom(int romFd, int saveFd);
         void writeSave();
@@ -60,6 +65,7 @@ class Cartridge
         FILE *romFile = nullptr;
         uint8_t *rom = nullptr, *save = nullptr;
         int romSize = 0, saveSize = -1;
+        bool romShared = false;
         bool saveDirty = false;
         std::mutex mutex;
 
@@ -79,6 +85,9 @@ class CartridgeNds: public Cartridge
     public:
         CartridgeNds(Core *core): Cartridge(core) {}
 
+        void saveState(FILE *file);
+        void loadState(FILE *file);
+
         void directBoot();
         void wordReady(bool cpu);
 
@@ -128,6 +137,9 @@ class CartridgeGba: public Cartridge
     public:
         CartridgeGba(Core *core): Cartridge(core) {}
 
+        void saveState(FILE *file);
+        void loadState(FILE *file);
+
         uint8_t *getRom(uint32_t address);
         bool isEeprom(uint32_t address);
 
@@ -25,12 +25,13 @@
 #include "settings.h"
 
 Core::Core(std::string ndsRom, std::string gbaRom, std::string ndsSave, std::string gbaSave,
-    int id, int ndsRomFd, int gbaRomFd, int ndsSaveFd, int gbaSaveFd):
-    id(id), bios { Bios(this, 0, Bios::swiTable9), Bios(this, 1, Bios::swiTable7), Bios(this, 1, Bios::swiTableGba) },
-    cartridgeNds(this), cartridgeGba(this), cp15(this), divSqrt(this), dldi(this), dma { Dma(this, 0),
-    Dma(this, 1) }, gpu(this), gpu2D { Gpu2D(this, 0), Gpu2D(this, 1) }, gpu3D(this), gpu3DRenderer(this),
-    input(this), interpreter { Interpreter(this, 0), Interpreter(this, 1) }, ipc(this), memory(this),
-    rtc(this), spi(this), spu(this), timers { Timers(this, 0), Timers(this, 1) }, wifi(this)
+    int id, int ndsRomFd, int gbaRomFd, int ndsSaveFd, int gbaSaveFd, SharedFiles *sharedFiles, bool memorySaves):
+    id(id), sharedFiles(sharedFiles), memorySaves(memorySaves), benchmark(this), bios { Bios(this, 0, Bios::swiTable9), Bios(this, 1, Bios::swiTable7),
+    Bios(this, 1, Bios::swiTableGba) }, cartridgeNds(this), cartridgeGba(this), cp15(this), divSqrt(this), dldi(this),
+    dma { Dma(this, 0), Dma(this, 1) }, gpu(this), gpu2D { Gpu2D(this, 0), Gpu2D(this, 1) }, gpu3D(this),
+    gpu3DRenderer(this), input(this), interpreter { Interpreter(this, 0), Interpreter(this, 1) }, ipc(this), jit(this),
+    memory(this), profiler(this), rewindBuffer(this), rtc(this), saveStates(this), spi(this), spu(this),
+    timers { Timers(this, 0), Timers(this, 1) }, wifi(this)
 {
     // Try to load BIOS and firmware; require DS files when not direct booting
     bool required = !Settings::directBoot || (ndsRom == "" && gbaRom == "" && ndsRomFd == -1 && gbaRomFd == -1);
@@ -39,36 +40,40 @@ Core::Core(std::string ndsRom, std::string gbaRom, std::string ndsSave, std::str
     if (!spi.loadFirmware() && required) throw ERROR_FIRM;
     realGbaBios = memory.loadGbaBios();
 
+    // Use the JIT instead of the interpreter if it's enabled and supported
+    if (jit.isEnabled())
+        runFunc = &Interpreter::runNdsFrame<true>;
+
     // Define the tasks that can be scheduled
-    tasks[RESET_CYCLES] = std::bind(&Core::resetCycles, this);
-    tasks[CART9_WORD_READY] = std::bind(&CartridgeNds::wordReady, &cartridgeNds, 0);
-    tasks[CART7_WORD_READY] = std::bind(&CartridgeNds::wordReady, &cartridgeNds, 1);
-    tasks[DMA9_TRANSFER0] = std::bind(&Dma::transfer, &dma[0], 0);
-    tasks[DMA9_TRANSFER1] = std::bind(&Dma::transfer, &dma[0], 1);
-    tasks[DMA9_TRANSFER2] = std::bind(&Dma::transfer, &dma[0], 2);
-    tasks[DMA9_TRANSFER3] = std::bind(&Dma::transfer, &dma[0], 3);
-    tasks[DMA7_TRANSFER0] = std::bind(&Dma::transfer, &dma[1], 0);
-    tasks[DMA7_TRANSFER1] = std::bind(&Dma::transfer, &dma[1], 1);
-    tasks[DMA7_TRANSFER2] = std::bind(&Dma::transfer, &dma[1], 2);
-    tasks[DMA7_TRANSFER3] = std::bind(&Dma::transfer, &dma[1], 3);
-    tasks[NDS_SCANLINE256] = std::bind(&Gpu::scanline256, &gpu);
-    tasks[NDS_SCANLINE355] = std::bind(&Gpu::scanline355, &gpu);
-    tasks[GBA_SCANLINE240] = std::bind(&Gpu::gbaScanline240, &gpu);
-    tasks[GBA_SCANLINE308] = std::bind(&Gpu::gbaScanline308, &gpu);
-    tasks[GPU3D_COMMAND] = std::bind(&Gpu3D::runCommand, &gpu3D);
-    tasks[ARM9_INTERRUPT] = std::bind(&Interpreter::interrupt, &interpreter[0]);
-    tasks[ARM7_INTERRUPT] = std::bind(&Interpreter::interrupt, &interpreter[1]);
-    tasks[NDS_SPU_SAMPLE] = std::bind(&Spu::runSample, &spu);
-    tasks[GBA_SPU_SAMPLE] = std::bind(&Spu::runGbaSample, &spu);
-    tasks[TIMER9_OVERFLOW0] = std::bind(&Timers::overflow, &timers[0], 0);
-    tasks[TIMER9_OVERFLOW1] = std::bind(&Timers::overflow, &timers[0], 1);
-    tasks[TIMER9_OVERFLOW2] = std::bind(&Timers::overflow, &timers[0], 2);
-    tasks[TIMER9_OVERFLOW3] = std::bind(&Timers::overflow, &timers[0], 3);
-    tasks[TIMER7_OVERFLOW0] = std::bind(&Timers::overflow, &timers[1], 0);
-    tasks[TIMER7_OVERFLOW1] = std::bind(&Timers::overflow, &timers[1], 1);
-    tasks[TIMER7_OVERFLOW2] = std::bind(&Timers::overflow, &timers[1], 2);
-    tasks[TIMER7_OVERFLOW3] = std::bind(&Timers::overflow, &timers[1], 3);
-    tasks[WIFI_COUNT_MS] = std::bind(&Wifi::countMs, &wifi);
+    tasks[RESET_CYCLES] = [](Core *core) { core->resetCycles(); };
+    tasks[CART9_WORD_READY] = [](Core *core) { core->cartridgeNds.wordReady(0); };
+    tasks[CART7_WORD_READY] = [](Core *core) { core->cartridgeNds.wordReady(1); };
+    tasks[DMA9_TRANSFER0] = [](Core *core) { core->dma[0].transfer(0); };
+    tasks[DMA9_TRANSFER1] = [](Core *core) { core->dma[0].transfer(1); };
+    tasks[DMA9_TRANSFER2] = [](Core *core) { core->dma[0].transfer(2); };
+    tasks[DMA9_TRANSFER3] = [](Core *core) { core->dma[0].transfer(3); };
+    tasks[DMA7_TRANSFER0] = [](Core *core) { core->dma[1].transfer(0); };
+    tasks[DMA7_TRANSFER1] = [](Core *core) { core->dma[1].transfer(1); };
+    tasks[DMA7_TRANSFER2] = [](Core *core) { core->dma[1].transfer(2); };
+    tasks[DMA7_TRANSFER3] = [](Core *core) { core->dma[1].transfer(3); };
+    tasks[NDS_SCANLINE256] = [](Core *core) { core->gpu.scanline256(); };
+    tasks[NDS_SCANLINE355] = [](Core *core) { core->gpu.scanline355(); };
+    tasks[GBA_SCANLINE240] = [](Core *core) { core->gpu.gbaScanline240(); };
+    tasks[GBA_SCANLINE308] = [](Core *core) { core->gpu.gbaScanline308(); };
+    tasks[GPU3D_COMMAND] = [](Core *core) { core->gpu3D.runCommand(); };
+    tasks[ARM9_INTERRUPT] = [](Core *core) { core->interpreter[0].interrupt(); };
+    tasks[ARM7_INTERRUPT] = [](Core *core) { core->interpreter[1].interrupt(); };
+    tasks[NDS_SPU_SAMPLE] = [](Core *core) { core->spu.runSample(); };
+    tasks[GBA_SPU_SAMPLE] = [](Core *core) { core->spu.runGbaSample(); };
+    tasks[TIMER9_OVERFLOW0] = [](Core *core) { core->timers[0].overflow(0); };
+    tasks[TIMER9_OVERFLOW1] = [](Core *core) { core->timers[0].overflow(1); };
+    tasks[TIMER9_OVERFLOW2] = [](Core *core) { core->timers[0].overflow(2); };
+    tasks[TIMER9_OVERFLOW3] = [](Core *core) { core->timers[0].overflow(3); };
+    tasks[TIMER7_OVERFLOW0] = [](Core *core) { core->timers[1].overflow(0); };
+    tasks[TIMER7_OVERFLOW1] = [](Core *core) { core->timers[1].overflow(1); };
+    tasks[TIMER7_OVERFLOW2] = [](Core *core) { core->timers[1].overflow(2); };
+    tasks[TIMER7_OVERFLOW3] = [](Core *core) { core->timers[1].overflow(3); };
+    tasks[WIFI_COUNT_MS] = [](Core *core) { core->wifi.countMs(); };
 
     // Schedule initial tasks for NDS mode
     schedule(RESET_CYCLES, 0x7FFFFFFF);
@@ -140,37 +145,108 @@ Core::Core(std::string ndsRom, std::string gbaRom, std::string ndsSave, std::str
 void Core::resetCycles()
 {
     // Reset the global cycle count periodically to prevent overflow
-    for (size_t i = 0; i < events.size(); i++)
-        events[i].cycles -= globalCycles;
+    for (int i = 0; i < MAX_TASKS; i++)
+        if (scheduled & BIT(i)) taskCycles[i] -= globalCycles;
+    if (scheduled) nextEvent -= globalCycles;
     for (int i = 0; i < 2; i++)
         interpreter[i].resetCycles(), timers[i].resetCycles();
     globalCycles -= globalCycles;
     schedule(RESET_CYCLES, 0x7FFFFFFF);
 }
 
+void Core::runFrame()
+{
+    // Step back in time before running a frame if rewinding
+    bool rewinding = rewindBuffer.isRewinding();
+    if (rewinding)
+        rewindBuffer.stepBack();
+
+    // Run the frame, timing it if benchmarking
+    if (benchmark.isEnabled())
+    {
+        benchmark.startFrame();
+        (*runFunc)(*this);
+        benchmark.endFrame();
+    }
+    else
+    {
+        (*runFunc)(*this);
+    }
+
+    // Capture the state for rewinding later, if not currently going back
+    if (!rewinding)
+        rewindBuffer.capture();
+}
+
 void Core::schedule(SchedTask task, uint32_t cycles)
 {
-    // Add a task to the scheduler, sorted by least to most cycles until execution
-    SchedEvent event(&tasks[task], globalCycles + cycles);
-    auto it = std::upper_bound(events.cbegin(), events.cend(), event);
-    events.insert(it, event);
+    // Schedule a task, replacing its previous time if it was already scheduled
+    // Tasks scheduled for the same cycle run in the order they were scheduled
+    taskCycles[task] = globalCycles + cycles;
+    taskOrders[task] = orderCount++;
+    scheduled |= BIT(task);
+
+    // Update the next task, searching again if the current next task was pushed back
+    if (task == nextTask)
+        updateNextEvent();
+    else if (taskCycles[task] < nextEvent)
+        nextEvent = taskCycles[nextTask = task];
+}
+
+void Core::unschedule(SchedTask task)
+{
+    // Remove a task from the scheduler, and search for a new next task if it was the next one
+    scheduled &= ~BIT(task);
+    if (task == nextTask)
+        updateNextEvent();
+}
+
+void Core::runEvents()
+{
+    // Run all tasks that are scheduled now
+    // Tasks are removed before running, since they can schedule themselves again
+    BenchSection last = benchmark.setSection(BENCH_SCHEDULER);
+    while (nextEvent <= globalCycles)
+    {
+        int task = nextTask;
+        unschedule(SchedTask(task));
+        PROFILED(ProfileTimer timer(profiler.tasks[task]));
+        (*tasks[task])(this);
+    }
+    benchmark.setSection(last);
+}
+
+void Core::updateNextEvent()
+{
+    // Find the scheduled task with the least cycles until execution
+    nextTask = MAX_TASKS;
+    nextEvent = -1;
+    for (int i = 0; i < MAX_TASKS; i++)
+    {
+        if (!(scheduled & BIT(i)) || taskCycles[i] > nextEvent) continue;
+        if (taskCycles[i] == nextEvent && nextTask != MAX_TASKS && int32_t(taskOrders[i] - taskOrders[nextTask]) > 0) continue;
+        nextEvent = taskCycles[nextTask = i];
+    }
 }
 
 void Core::enterGbaMode()
 {
     // Switch to GBA mode
     gbaMode = true;
-    runFunc = &Interpreter::runGbaFrame;
+    runFunc = jit.isEnabled() ? &Interpreter::runGbaFrame<true> : &Interpreter::runGbaFrame<false>;
     running.store(false);
 
     // Reset the scheduler and schedule initial tasks for GBA mode
-    events.clear();
+    scheduled = 0;
+    updateNextEvent();
     schedule(RESET_CYCLES, 1);
     schedule(GBA_SCANLINE240, 240 * 4);
     schedule(GBA_SCANLINE308, 308 * 4);
     schedule(GBA_SPU_SAMPLE, 512);
 
     // Reset the system for GBA mode
+    // Compiled blocks are dropped, since the ARM7 no longer runs at half speed
+    jit.flush();
     memory.updateMap7(0x00000000, 0xFFFFFFFF);
     interpreter[1].init();
     rtc.reset();
@@ -209,3 +285,35 @@ void Core::endFrame()
     if (wifi.shouldSchedule())
         wifi.scheduleInit();
 }
+
+void Core::saveState(FILE *file)
+{
+    // Write the scheduler state to the file
+    // The task functions are fixed, so only the pending timestamps are needed
+    fwrite(&globalCycles, sizeof(globalCycles), 1, file);
+    fwrite(taskCycles, sizeof(taskCycles), 1, file);
+    fwrite(taskOrders, sizeof(taskOrders), 1, file);
+    fwrite(&scheduled, sizeof(scheduled), 1, file);
+    fwrite(&orderCount, sizeof(orderCount), 1, file);
+}
+
+void Core::loadState(FILE *file)
+{
+    // Read the scheduler state from the file and find the next event
+    fread(&globalCycles, sizeof(globalCycles), 1, file);
+    fread(taskCycles, sizeof(taskCycles), 1, file);
+    fread(taskOrders, sizeof(taskOrders), 1, file);
+    fread(&scheduled, sizeof(scheduled), 1, file);
+    fread(&orderCount, sizeof(orderCount), 1, file);
+    updateNextEvent();
+}
+
+bool Core::checkState(FILE *file)
+{
+    // Skip to the scheduled task mask, and check that it only has tasks that exist
+    uint32_t mask;
+    fseek(file, sizeof(globalCycles) + sizeof(taskCycles) + sizeof(taskOrders), SEEK_CUR);
+    if (fread(&mask, sizeof(mask), 1, file) != 1)
+        return false;
+    return MAX_TASKS == 32 || !(mask >> MAX_TASKS);
+}
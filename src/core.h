@@ -22,10 +22,9 @@
 
 #include <chrono>
 #include <cstdint>
-#include <functional>
 #include <string>
-#include <vector>
 
+#include "benchmark.h"
 #include "bios.h"
 #include "cartridge.h"
 #include "cp15.h"
@@ -40,8 +39,13 @@
 #include "input.h"
 #include "interpreter.h"
 #include "ipc.h"
+#include "jit.h"
 #include "memory.h"
+#include "profiler.h"
+#include "rewind_buffer.h"
 #include "rtc.h"
+#include "save_states.h"
+#include "shared_files.h"
 #include "spi.h"
 #include "spu.h"
 #include "timers.h"
@@ -88,14 +92,8 @@ enum SchedTask
     MAX_TASKS
 };
 
-struct SchedEvent
-{
-    std::function<void()> *task;
-    uint32_t cycles;
-
-    SchedEvent(std::function<void()> *task, uint32_t cycles): task(task), cycles(cycles) {}
-    bool operator<(const SchedEvent &event) const { return cycles < event.cycles; }
-};
+// Scheduled tasks are tracked as bits in a 32-bit mask
+static_assert(MAX_TASKS <= 32, "Too many scheduler tasks for the pending task mask");
 
 class Core
 {
@@ -103,7 +101,10 @@ class Core
         int id = 0;
         bool gbaMode = false;
         int fps = 0;
+        SharedFiles *sharedFiles = nullptr;
+        bool memorySaves = false;
 
+        Benchmark benchmark;
         Bios bios[3];
         CartridgeNds cartridgeNds;
         CartridgeGba cartridgeGba;
@@ -118,33 +119,50 @@ class Core
         Input input;
         Interpreter interpreter[2];
         Ipc ipc;
+        Jit jit;
         Memory memory;
+        Profiler profiler;
+        RewindBuffer rewindBuffer;
         Rtc rtc;
+        SaveStates saveStates;
         Spi spi;
         Spu spu;
         Timers timers[2];
         Wifi wifi;
 
         std::atomic<bool> running;
-        std::vector<SchedEvent> events;
         uint32_t globalCycles = 0;
+        uint32_t nextEvent = -1;
 
         Core(std::string ndsRom = "", std::string gbaRom = "", std::string ndsSave = "", std::string gbaSave = "",
-             int id = 0, int ndsRomFd = -1, int gbaRomFd = -1, int ndsSaveFd = -1, int gbaSaveFd = -1);
+             int id = 0, int ndsRomFd = -1, int gbaRomFd = -1, int ndsSaveFd = -1, int gbaSaveFd = -1,
+             SharedFiles *sharedFiles = nullptr, bool memorySaves = false);
 
-        void runFrame() { (*runFunc)(*this); }
+        void runFrame();
         void schedule(SchedTask task, uint32_t cycles);
+        void unschedule(SchedTask task);
+        void runEvents();
         void enterGbaMode();
         void endFrame();
 
+        void saveState(FILE *file);
+        void loadState(FILE *file);
+        bool checkState(FILE *file);
+
     private:
         bool realGbaBios;
-        std::function<void()> tasks[MAX_TASKS];
-        void (*runFunc)(Core&) = &Interpreter::runNdsFrame;
+        void (*tasks[MAX_TASKS])(Core*) = {};
+        uint32_t taskCycles[MAX_TASKS] = {};
+        uint32_t taskOrders[MAX_TASKS] = {};
+        uint32_t scheduled = 0;
+        uint32_t orderCount = 0;
+        int nextTask = MAX_TASKS;
+        void (*runFunc)(Core&) = &Interpreter::runNdsFrame<false>;
         std::chrono::steady_clock::time_point lastFpsTime;
         int fpsCount = 0;
 
         void resetCycles();
+        void updateNextEvent();
 };
 
 #endif // CORE_H
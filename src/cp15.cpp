@@ -108,3 +108,60 @@ void Cp15::write(int cn, int cm, int cp, uint32_t value)
         }
     }
 }
+
+void Cp15::saveState(FILE *file)
+{
+    // Write state data to the file
+    fwrite(&ctrlReg, sizeof(ctrlReg), 1, file);
+    fwrite(&dtcmReg, sizeof(dtcmReg), 1, file);
+    fwrite(&itcmReg, sizeof(itcmReg), 1, file);
+    fwrite(&exceptionAddr, sizeof(exceptionAddr), 1, file);
+    fwrite(&dtcmReadEnabled, sizeof(dtcmReadEnabled), 1, file);
+    fwrite(&dtcmWriteEnabled, sizeof(dtcmWriteEnabled), 1, file);
+    fwrite(&itcmReadEnabled, sizeof(itcmReadEnabled), 1, file);
+    fwrite(&itcmWriteEnabled, sizeof(itcmWriteEnabled), 1, file);
+    fwrite(&dtcmAddr, sizeof(dtcmAddr), 1, file);
+    fwrite(&dtcmSize, sizeof(dtcmSize), 1, file);
+    fwrite(&itcmSize, sizeof(itcmSize), 1, file);
+}
+
+void Cp15::loadState(FILE *file)
+{
+    uint32_t dtcmAddrOld = dtcmAddr;
+    uint32_t dtcmSizeOld = dtcmSize;
+    uint32_t itcmSizeOld = itcmSize;
+
+    // Read state data from the file
+    fread(&ctrlReg, sizeof(ctrlReg), 1, file);
+    fread(&dtcmReg, sizeof(dtcmReg), 1, file);
+    fread(&itcmReg, sizeof(itcmReg), 1, file);
+    fread(&exceptionAddr, sizeof(exceptionAddr), 1, file);
+    fread(&dtcmReadEnabled, sizeof(dtcmReadEnabled), 1, file);
+    fread(&dtcmWriteEnabled, sizeof(dtcmWriteEnabled), 1, file);
+    fread(&itcmReadEnabled, sizeof(itcmReadEnabled), 1, file);
+    fread(&itcmWriteEnabled, sizeof(itcmWriteEnabled), 1, file);
+    fread(&dtcmAddr, sizeof(dtcmAddr), 1, file);
+    fread(&dtcmSize, sizeof(dtcmSize), 1, file);
+    fread(&itcmSize, sizeof(itcmSize), 1, file);
+
+    // Update the TCM mappings in both the old and new locations
+    core->memory.updateMap9<true>(dtcmAddrOld, dtcmAddrOld + dtcmSizeOld);
+    core->memory.updateMap9<true>(dtcmAddr, dtcmAddr + dtcmSize);
+    core->memory.updateMap9<true>(0x00000000, std::max(itcmSizeOld, itcmSize));
+}
+
+bool Cp15::checkState(FILE *file)
+{
+    // Skip to the TCM settings, which are used to rebuild the memory maps
+    uint32_t addr, sizes[2];
+    fseek(file, sizeof(ctrlReg) + sizeof(dtcmReg) + sizeof(itcmReg) + sizeof(exceptionAddr) + sizeof(dtcmReadEnabled) +
+        sizeof(dtcmWriteEnabled) + sizeof(itcmReadEnabled) + sizeof(itcmWriteEnabled), SEEK_CUR);
+    if (fread(&addr, sizeof(addr), 1, file) != 1 || fread(sizes, sizeof(uint32_t), 2, file) != 2)
+        return false;
+
+    // Check that the DTCM is page-aligned, and that the sizes are unset or a power of 2 of at least 4KB
+    for (int i = 0; i < 2; i++)
+        if (sizes[i] != 0 && (sizes[i] < 0x1000 || (sizes[i] & (sizes[i] - 1))))
+            return false;
+    return !(addr & 0xFFF);
+}
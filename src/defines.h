@@ -29,6 +29,13 @@
 #define LOG(...) (0)
 #endif
 
+// Enable or disable profiling counters; statements wrapped in this are removed entirely when disabled
+#ifdef PROFILE
+#define PROFILED(...) __VA_ARGS__
+#else
+#define PROFILED(...)
+#endif
+
 // Compatibility toggle for systems that don't have fdopen
 #ifdef NO_FDOPEN
 #define fdopen(...) (0)
@@ -53,6 +53,7 @@ class InputDialog: public wxDialog
         wxButton *keyFullScreen;
         wxButton *keyEnlargeSwap;
         wxButton *keySystemPause;
+        wxButton *keyRewind;
 
         int keyBinds[MAX_KEYS];
         std::vector<int> axisBases;
@@ -80,6 +81,7 @@ class InputDialog: public wxDialog
         void remapFullScreen(wxCommandEvent &event);
         void remapEnlargeSwap(wxCommandEvent &event);
         void remapSystemPause(wxCommandEvent &event);
+        void remapRewind(wxCommandEvent &event);
         void clearMap(wxCommandEvent &event);
         void updateJoystick(wxTimerEvent &event);
         void confirm(wxCommandEvent &event);
@@ -36,7 +36,7 @@ wxEND_EVENT_TABLE()
 
 int NooApp::screenFilter = 1;
 int NooApp::micEnable = 1;
-int NooApp::keyBinds[] = { 'L', 'K', 'G', 'H', 'D', 'A', 'W', 'S', 'P', 'Q', 'O', 'I', WXK_TAB, 0, WXK_ESCAPE, 0, WXK_BACK };
+int NooApp::keyBinds[] = { 'L', 'K', 'G', 'H', 'D', 'A', 'W', 'S', 'P', 'Q', 'O', 'I', WXK_TAB, 0, WXK_ESCAPE, 0, WXK_BACK, 0 };
 
 bool NooApp::OnInit()
 {
@@ -63,7 +63,8 @@ bool NooApp::OnInit()
         Setting("keyFastToggle",  &keyBinds[13], false),
         Setting("keyFullScreen",  &keyBinds[14], false),
         Setting("keyEnlargeSwap", &keyBinds[15], false),
-        Setting("keySystemPause", &keyBinds[16], false)
+        Setting("keySystemPause", &keyBinds[16], false),
+        Setting("keyRewind",      &keyBinds[17], false)
     };
 
     // Add the platform settings
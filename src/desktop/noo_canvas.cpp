@@ -133,28 +133,29 @@ void NooCanvas::draw(wxPaintEvent &event)
             frame->SendSizeEvent();
         }
 
+        // Scale the screen resolutions if high-res is enabled, and size the framebuffer to match
+        int scale = Settings::getScale3D();
+        framebuffer.resize(256 * 192 * 2 * scale * scale);
+
         // Emulation is limited by audio, so frames aren't always generated at a consistent rate
         // This can mess up frame pacing at higher refresh rates when frames are ready too soon
         // To solve this, use a software-based swap interval to wait before getting the next frame
-        if (++frameCount >= swapInterval && frame->getCore()->gpu.getFrame(framebuffer, gba))
+        if (++frameCount >= swapInterval && frame->getCore()->gpu.getFrame(&framebuffer[0], gba))
             frameCount = 0;
 
-        // Shift the screen resolutions if high-res is enabled
-        bool resShift = Settings::highRes3D;
-
         if (gbaMode)
         {
             // Draw the GBA screen
             drawScreen(layout.topX, layout.topY, layout.topWidth, layout.topHeight,
-               240 << resShift, 160 << resShift, &framebuffer[0]);
+               240 * scale, 160 * scale, &framebuffer[0]);
         }
         else
         {
             // Draw the DS top and bottom screens
             drawScreen(layout.topX, layout.topY, layout.topWidth, layout.topHeight,
-               256 << resShift, 192 << resShift, &framebuffer[0]);
+               256 * scale, 192 * scale, &framebuffer[0]);
             drawScreen(layout.botX, layout.botY, layout.botWidth, layout.botHeight,
-               256 << resShift, 192 << resShift, &framebuffer[(256 * 192) << (resShift * 2)]);
+               256 * scale, 192 * scale, &framebuffer[256 * 192 * scale * scale]);
         }
     }
 
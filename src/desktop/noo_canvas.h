@@ -21,6 +21,7 @@
 #define NOO_CANVAS_H
 
 #include <chrono>
+#include <vector>
 #include <wx/wx.h>
 
 #include "../common/screen_layout.h"
@@ -50,7 +51,7 @@ class NooCanvas: public CANVAS_CLASS
         wxGLContext *context;
 
         ScreenLayout layout;
-        uint32_t framebuffer[256 * 192 * 8] = {};
+        std::vector<uint32_t> framebuffer;
         bool gbaMode = false;
         uint8_t sizeReset = 0;
         bool finished = false;
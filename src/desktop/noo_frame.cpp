@@ -52,6 +52,8 @@ enum FrameEvent
     THREADED_3D_2,
     THREADED_3D_3,
     HIGH_RES_3D,
+    JIT_ENABLE,
+    REWIND_ENABLE,
     MIC_ENABLE,
     UPDATE_JOY
 };
@@ -79,6 +81,8 @@ EVT_MENU(THREADED_3D_1,  NooFrame::threaded3D1)
 EVT_MENU(THREADED_3D_2,  NooFrame::threaded3D2)
 EVT_MENU(THREADED_3D_3,  NooFrame::threaded3D3)
 EVT_MENU(HIGH_RES_3D,    NooFrame::highRes3D)
+EVT_MENU(JIT_ENABLE,     NooFrame::jitEnable)
+EVT_MENU(REWIND_ENABLE,  NooFrame::rewindEnable)
 EVT_MENU(MIC_ENABLE,     NooFrame::micEnable)
 EVT_TIMER(UPDATE_JOY,    NooFrame::updateJoystick)
 EVT_DROP_FILES(NooFrame::dropFiles)
@@ -161,12 +165,17 @@ NooFrame::NooFrame(NooApp *app, int id, std::string path):
     settingsMenu->AppendSeparator();
     settingsMenu->AppendCheckItem(HIGH_RES_3D, "&High-Resolution 3D");
     settingsMenu->AppendSeparator();
+    settingsMenu->AppendCheckItem(JIT_ENABLE,  "&JIT (Threaded Code)");
+    settingsMenu->AppendCheckItem(REWIND_ENABLE, "&Rewind Buffer");
+    settingsMenu->AppendSeparator();
     settingsMenu->AppendCheckItem(MIC_ENABLE,  "&Use Microphone");
 
     // Set the current values of the checkboxes
     settingsMenu->Check(DIRECT_BOOT, Settings::directBoot);
     settingsMenu->Check(THREADED_2D, Settings::threaded2D);
     settingsMenu->Check(HIGH_RES_3D, Settings::highRes3D);
+    settingsMenu->Check(JIT_ENABLE,  Settings::jit);
+    settingsMenu->Check(REWIND_ENABLE, Settings::rewind);
     settingsMenu->Check(MIC_ENABLE,  NooApp::micEnable);
 
     // Set up the menu bar
@@ -413,6 +422,12 @@ void NooFrame::pressKey(int key)
             }
             break;
 
+        case 17: // Rewind Hold
+            // Step back in time while the hotkey is held
+            if (running)
+                core->rewindBuffer.setRewinding(true);
+            break;
+
         default: // Core input
             // Send a key press to the core
             if (running)
@@ -442,6 +457,12 @@ void NooFrame::releaseKey(int key)
             hotkeyToggles &= ~BIT(key - 13);
             break;
 
+        case 17: // Rewind Hold
+            // Stop stepping back in time, even if the core was paused while rewinding
+            if (core)
+                core->rewindBuffer.setRewinding(false);
+            break;
+
         default: // Core input
             // Send a key release to the core
             if (running)
@@ -658,6 +679,20 @@ void NooFrame::highRes3D(wxCommandEvent &event)
     Settings::save();
 }
 
+void NooFrame::jitEnable(wxCommandEvent &event)
+{
+    // Toggle the JIT setting; this takes effect when a core is next started
+    Settings::jit = !Settings::jit;
+    Settings::save();
+}
+
+void NooFrame::rewindEnable(wxCommandEvent &event)
+{
+    // Toggle the rewind buffer setting; states are freed when it's disabled
+    Settings::rewind = !Settings::rewind;
+    Settings::save();
+}
+
 void NooFrame::micEnable(wxCommandEvent &event)
 {
     // Toggle the use microphone setting
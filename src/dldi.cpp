@@ -28,24 +28,41 @@ Dldi::~Dldi()
         fclose(sdImage);
 }
 
+bool Dldi::isDriver(const uint8_t *rom, size_t offset)
+{
+    // Check for the DLDI magic number
+    if (U8TO32(rom, offset) != 0xBF8DA5ED)
+        return false;
+
+    // Check for the DLDI magic string
+    const char *str = " Chishm\0";
+    for (size_t j = 0; j < 8; j++)
+    {
+        if (rom[offset + 4 + j] != str[j])
+            return false;
+    }
+    return true;
+}
+
+bool Dldi::hasDriver(const uint8_t *rom, size_t size)
+{
+    // Scan the ROM for DLDI drivers without patching them
+    for (size_t i = 0; i < size; i += 0x40)
+    {
+        if (isDriver(rom, i))
+            return true;
+    }
+    return false;
+}
+
 void Dldi::patchRom(uint8_t *rom, size_t offset, size_t size)
 {
     // Scan the ROM for DLDI drivers and patch them if found
     for (size_t i = 0; i < size; i += 0x40)
     {
-        // Check for the DLDI magic number
-        if (U8TO32(rom, i) != 0xBF8DA5ED)
-        next:
+        if (!isDriver(rom, i))
             continue;
 
-        // Check for the DLDI magic string
-        const char *str = " Chishm\0";
-        for (size_t j = 0; j < 8; j++)
-        {
-            if (rom[i + 4 + j] != str[j])
-                goto next;
-        }
-
         // Patch the DLDI driver to use the HLE functions
         rom[i + 0x0F] = 0x0E;                     // Size of driver in terms of 1 << n (16KB)
         uint32_t address = U8TO32(rom, i + 0x40); // Address of driver
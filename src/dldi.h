@@ -41,6 +41,7 @@ class Dldi
         Dldi(Core *core): core(core) {}
         ~Dldi();
 
+        static bool hasDriver(const uint8_t *rom, size_t size);
         void patchRom(uint8_t *rom, size_t offset, size_t size);
         bool isPatched() { return patched; }
 
@@ -56,6 +57,8 @@ class Dldi
 
         bool patched = false;
         FILE *sdImage = nullptr;
+
+        static bool isDriver(const uint8_t *rom, size_t offset);
 };
 
 #endif // DLDI_H
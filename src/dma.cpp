@@ -17,9 +17,80 @@
     along with NooDS. If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
+#include <cstring>
+
 #include "dma.h"
 #include "core.h"
 
+template <typename T> void Dma::copy(int channel, uint32_t count, int srcAddrCnt, int dstAddrCnt)
+{
+    for (uint32_t i = 0; i < count;)
+    {
+        uint32_t src = srcAddrs[channel];
+        uint32_t dst = dstAddrs[channel];
+        bool srcInc = (srcAddrCnt == 0);
+        bool dstInc = (dstAddrCnt == 0 || dstAddrCnt == 3);
+
+        // Move data straight between blocks of plain memory when the destination increments
+        // Anything without a direct mapping, like I/O or protected code, is left to the memory handlers
+        uint8_t *srcBlock, *dstBlock;
+        if (dstInc && srcAddrCnt != 1 && !((src | dst) & (sizeof(T) - 1)) &&
+            (srcBlock = core->memory.getReadBlock(cpu, src)) && (dstBlock = core->memory.getWriteBlock(cpu, dst)))
+        {
+            // Copy up to the end of whichever 4KB block ends first
+            uint32_t units = std::min<uint32_t>(count - i, (0x1000 - (dst & 0xFFF)) / sizeof(T));
+            if (srcInc) units = std::min<uint32_t>(units, (0x1000 - (src & 0xFFF)) / sizeof(T));
+            uint8_t *srcData = &srcBlock[src & 0xFFF];
+            uint8_t *dstData = &dstBlock[dst & 0xFFF];
+
+            if (!srcInc)
+            {
+                // Fill the destination with the same value from a fixed source
+                T value;
+                memcpy(&value, srcData, sizeof(T));
+                for (uint32_t j = 0; j < units; j++)
+                    memcpy(&dstData[j * sizeof(T)], &value, sizeof(T));
+            }
+            else if (dstData > srcData && dstData < srcData + units * sizeof(T))
+            {
+                // Copy one unit at a time if the destination overlaps ahead of the source, repeating data like hardware
+                for (uint32_t j = 0; j < units; j++)
+                    memcpy(&dstData[j * sizeof(T)], &srcData[j * sizeof(T)], sizeof(T));
+            }
+            else
+            {
+                // Copy the whole range at once
+                memmove(dstData, srcData, units * sizeof(T));
+            }
+
+            if (srcInc) srcAddrs[channel] += units * sizeof(T);
+            dstAddrs[channel] += units * sizeof(T);
+            PROFILED(core->profiler.dmaUnits[cpu][channel] += units);
+            i += units;
+            continue;
+        }
+
+        // Transfer a single unit
+        T value = core->memory.read<T>(cpu, src, false);
+        core->memory.write<T>(cpu, dst, value, false);
+        PROFILED(core->profiler.dmaUnits[cpu][channel]++);
+
+        // Adjust the source address
+        if (srcAddrCnt == 0) // Increment
+            srcAddrs[channel] += sizeof(T);
+        else if (srcAddrCnt == 1) // Decrement
+            srcAddrs[channel] -= sizeof(T);
+
+        // Adjust the destination address
+        if (dstInc) // Increment
+            dstAddrs[channel] += sizeof(T);
+        else if (dstAddrCnt == 1) // Decrement
+            dstAddrs[channel] -= sizeof(T);
+        i++;
+    }
+}
+
 void Dma::transfer(int channel)
 {
     int dstAddrCnt = (dmaCnt[channel] & 0x00600000) >> 21;
@@ -36,6 +107,7 @@ void Dma::transfer(int channel)
             // GBA sound DMAs always transfer 4 words and never adjust the destination address
             uint32_t value = core->memory.read<uint32_t>(cpu, srcAddrs[channel], false);
             core->memory.write<uint32_t>(cpu, dstAddrs[channel], value, false);
+            PROFILED(core->profiler.dmaUnits[cpu][channel]++);
 
             // Adjust the source address
             if (srcAddrCnt == 0) // Increment
@@ -44,55 +116,35 @@ void Dma::transfer(int channel)
                 srcAddrs[channel] -= 4;
         }
     }
-    else if (dmaCnt[channel] & BIT(26)) // Whole word transfer
+    else if (mode == 7 && cpu == 0 && (dmaCnt[channel] & BIT(26)) && dstAddrCnt == 2 &&
+        (dstAddrs[channel] & ~0x3F) == 0x4000400) // GXFIFO transfer
     {
-        for (unsigned int i = 0; i < wordCounts[channel]; i++)
+        // Gather up to 112 words and hand them to the geometry engine in one batch
+        // This skips the register lookup and FIFO status update that each word would get as a normal write
+        uint32_t words[112];
+        gxFifoCount = std::min(wordCounts[channel], 112U);
+        for (int i = 0; i < gxFifoCount; i++)
         {
-            // Transfer a word
-            uint32_t value = core->memory.read<uint32_t>(cpu, srcAddrs[channel], false);
-            core->memory.write<uint32_t>(cpu, dstAddrs[channel], value, false);
+            words[i] = core->memory.read<uint32_t>(cpu, srcAddrs[channel], false);
+            PROFILED(core->profiler.dmaUnits[cpu][channel]++);
 
             // Adjust the source address
             if (srcAddrCnt == 0) // Increment
                 srcAddrs[channel] += 4;
             else if (srcAddrCnt == 1) // Decrement
                 srcAddrs[channel] -= 4;
-
-            // Adjust the destination address
-            if (dstAddrCnt == 0 || dstAddrCnt == 3) // Increment
-                dstAddrs[channel] += 4;
-            else if (dstAddrCnt == 1) // Decrement
-                dstAddrs[channel] -= 4;
-
-            // In GXFIFO mode, only send 112 words at a time
-            if (mode == 7 && ++gxFifoCount == 112)
-                break;
         }
+        core->gpu3D.writeGxFifo(words, gxFifoCount);
     }
-    else // Half-word transfer
+    else
     {
-        for (unsigned int i = 0; i < wordCounts[channel]; i++)
-        {
-            // Transfer a half-word
-            uint16_t value = core->memory.read<uint16_t>(cpu, srcAddrs[channel], false);
-            core->memory.write<uint16_t>(cpu, dstAddrs[channel], value, false);
-
-            // Adjust the source address
-            if (srcAddrCnt == 0) // Increment
-                srcAddrs[channel] += 2;
-            else if (srcAddrCnt == 1) // Decrement
-                srcAddrs[channel] -= 2;
-
-            // Adjust the destination address
-            if (dstAddrCnt == 0 || dstAddrCnt == 3) // Increment
-                dstAddrs[channel] += 2;
-            else if (dstAddrCnt == 1) // Decrement
-                dstAddrs[channel] -= 2;
-
-            // In GXFIFO mode, only send 112 words at a time
-            if (mode == 7 && ++gxFifoCount == 112)
-                break;
-        }
+        // Transfer words or half-words, only sending 112 words at a time in GXFIFO mode
+        uint32_t count = (mode == 7) ? std::min(wordCounts[channel], 112U) : wordCounts[channel];
+        if (dmaCnt[channel] & BIT(26)) // Whole word transfer
+            copy<uint32_t>(channel, count, srcAddrCnt, dstAddrCnt);
+        else // Half-word transfer
+            copy<uint16_t>(channel, count, srcAddrCnt, dstAddrCnt);
+        gxFifoCount = count;
     }
 
     if (mode == 7)
@@ -193,3 +245,25 @@ uint32_t Dma::readDmaCnt(int channel)
     // The lower half-word isn't readable in GBA mode
     return dmaCnt[channel] & ~(core->gbaMode ? 0x0000FFFF : 0x00000000);
 }
+
+void Dma::saveState(FILE *file)
+{
+    // Write state data to the file
+    fwrite(srcAddrs, sizeof(srcAddrs), 1, file);
+    fwrite(dstAddrs, sizeof(dstAddrs), 1, file);
+    fwrite(wordCounts, sizeof(wordCounts), 1, file);
+    fwrite(dmaSad, sizeof(dmaSad), 1, file);
+    fwrite(dmaDad, sizeof(dmaDad), 1, file);
+    fwrite(dmaCnt, sizeof(dmaCnt), 1, file);
+}
+
+void Dma::loadState(FILE *file)
+{
+    // Read state data from the file
+    fread(srcAddrs, sizeof(srcAddrs), 1, file);
+    fread(dstAddrs, sizeof(dstAddrs), 1, file);
+    fread(wordCounts, sizeof(wordCounts), 1, file);
+    fread(dmaSad, sizeof(dmaSad), 1, file);
+    fread(dmaDad, sizeof(dmaDad), 1, file);
+    fread(dmaCnt, sizeof(dmaCnt), 1, file);
+}
@@ -21,6 +21,7 @@
 #define DMA_H
 
 #include <cstdint>
+#include <cstdio>
 
 class Core;
 
@@ -29,6 +30,9 @@ class Dma
     public:
         Dma(Core *core, bool cpu): core(core), cpu(cpu) {}
 
+        void saveState(FILE *file);
+        void loadState(FILE *file);
+
         void transfer(int channel);
         void trigger(int mode, uint8_t channels = 0xF);
 
@@ -51,6 +55,8 @@ class Dma
         uint32_t dmaSad[4] = {};
         uint32_t dmaDad[4] = {};
         uint32_t dmaCnt[4] = {};
+
+        template <typename T> void copy(int channel, uint32_t count, int srcAddrCnt, int dstAddrCnt);
 };
 
 #endif // DMA_H
@@ -77,6 +77,14 @@ uint16_t Gpu::rgb6ToRgb5(uint32_t color)
     return BIT(15) | (b << 10) | (g << 5) | r;
 }
 
+void Gpu::fillScaled(uint32_t *out, int stride, int scale, uint32_t color)
+{
+    // Fill a block of pixels with one color, to draw a native pixel at a higher scale
+    for (int y = 0; y < scale; y++)
+        for (int x = 0; x < scale; x++)
+            out[y * stride + x] = color;
+}
+
 bool Gpu::getFrame(uint32_t *out, bool gbaCrop)
 {
     // Check if a new frame is ready
@@ -86,10 +94,13 @@ bool Gpu::getFrame(uint32_t *out, bool gbaCrop)
     // Get the next queued buffers
     Buffers &buffers = framebuffers.front();
 
+    // Get the scale to output at, which is the same as the 3D resolution scale
+    int scale = Settings::getScale3D();
+
     if (gbaCrop)
     {
         // Output the frame in RGB8 format, cropped for GBA
-        if (Settings::highRes3D)
+        if (scale > 1)
         {
             // GBA doesn't have 3D, but draw the screen upscaled for consistency
             for (int y = 0; y < 160; y++)
@@ -97,11 +108,7 @@ bool Gpu::getFrame(uint32_t *out, bool gbaCrop)
                 for (int x = 0; x < 240; x++)
                 {
                     uint32_t color = rgb5ToRgb8(buffers.framebuffer[y * 256 + x]);
-                    int i = (y * 2) * (240 * 2) + (x * 2);
-                    out[i + 0] = color;
-                    out[i + 1] = color;
-                    out[i + 480] = color;
-                    out[i + 481] = color;
+                    fillScaled(&out[(y * 240 * scale + x) * scale], 240 * scale, scale, color);
                 }
             }
         }
@@ -122,7 +129,7 @@ bool Gpu::getFrame(uint32_t *out, bool gbaCrop)
         // The DS draws the GBA screen by capturing it to alternating VRAM blocks and then displaying that
         // While not used officially, it's possible to copy images into VRAM before entering GBA mode to use as a border
         // Output the GBA frame, centered, with the current VRAM border around it
-        if (Settings::highRes3D)
+        if (scale > 1)
         {
             // GBA doesn't have 3D, but draw the screen upscaled for consistency
             for (int y = 0; y < 192; y++)
@@ -132,16 +139,12 @@ bool Gpu::getFrame(uint32_t *out, bool gbaCrop)
                     uint32_t color = rgb5ToRgb8((x >= 8 && x < 256 - 8 && y >= 16 && y < 192 - 16) ?
                         buffers.framebuffer[(y - 16) * 256 + (x - 8)] :
                         core->memory.read<uint16_t>(0, base + (y * 256 + x) * 2));
-                    int i = (offset * 4) + (y * 2) * (256 * 2) + (x * 2);
-                    out[i + 0] = color;
-                    out[i + 1] = color;
-                    out[i + 512] = color;
-                    out[i + 513] = color;
+                    fillScaled(&out[offset * scale * scale + (y * 256 * scale + x) * scale], 256 * scale, scale, color);
                 }
             }
 
             // Clear the secondary display
-            memset(&out[(256 * 192 - offset) * 4], 0, 256 * 192 * 4 * sizeof(uint32_t));
+            memset(&out[(256 * 192 - offset) * scale * scale], 0, 256 * 192 * scale * scale * sizeof(uint32_t));
         }
         else
         {
@@ -163,35 +166,33 @@ bool Gpu::getFrame(uint32_t *out, bool gbaCrop)
     else
     {
         // Output the full frame in RGB8 format
-        if (Settings::highRes3D)
+        if (scale > 1)
         {
-            if (buffers.hiRes3D)
+            if (buffers.hiRes3D && buffers.scale3D == scale)
             {
                 // Draw the screens upscaled, replacing any 3D pixels with high-res output
+                // The 3D output covers one screen, so wrap around to it for whichever screen shows 3D
+                int size = 256 * 192 * scale * scale;
                 for (int y = 0; y < 192 * 2; y++)
                 {
                     for (int x = 0; x < 256; x++)
                     {
                         uint32_t value = buffers.framebuffer[y * 256 + x];
-                        int i = (y * 2) * (256 * 2) + (x * 2);
+                        int i = (y * 256 * scale + x) * scale;
                         if (value & BIT(26)) // 3D
                         {
-                            uint32_t value2 = buffers.hiRes3D[(i + 0) % (256 * 192 * 4)];
-                            out[i + 0] = rgb6ToRgb8((value2 & 0xFC0000) ? value2 : value);
-                            value2 = buffers.hiRes3D[(i + 1) % (256 * 192 * 4)];
-                            out[i + 1] = rgb6ToRgb8((value2 & 0xFC0000) ? value2 : value);
-                            value2 = buffers.hiRes3D[(i + 512) % (256 * 192 * 4)];
-                            out[i + 512] = rgb6ToRgb8((value2 & 0xFC0000) ? value2 : value);
-                            value2 = buffers.hiRes3D[(i + 513) % (256 * 192 * 4)];
-                            out[i + 513] = rgb6ToRgb8((value2 & 0xFC0000) ? value2 : value);
+                            for (int j = 0; j < scale; j++)
+                            {
+                                for (int k = i + j * 256 * scale; k < i + j * 256 * scale + scale; k++)
+                                {
+                                    uint32_t value2 = buffers.hiRes3D[k % size];
+                                    out[k] = rgb6ToRgb8((value2 & 0xFC0000) ? value2 : value);
+                                }
+                            }
                         }
                         else
                         {
-                            uint32_t color = rgb6ToRgb8(value);
-                            out[i + 0] = color;
-                            out[i + 1] = color;
-                            out[i + 512] = color;
-                            out[i + 513] = color;
+                            fillScaled(&out[i], 256 * scale, scale, rgb6ToRgb8(value));
                         }
                     }
                 }
@@ -204,11 +205,7 @@ bool Gpu::getFrame(uint32_t *out, bool gbaCrop)
                     for (int x = 0; x < 256; x++)
                     {
                         uint32_t color = rgb6ToRgb8(buffers.framebuffer[y * 256 + x]);
-                        int i = (y * 2) * (256 * 2) + (x * 2);
-                        out[i + 0] = color;
-                        out[i + 1] = color;
-                        out[i + 512] = color;
-                        out[i + 513] = color;
+                        fillScaled(&out[(y * 256 * scale + x) * scale], 256 * scale, scale, color);
                     }
                 }
             }
@@ -237,6 +234,8 @@ void Gpu::gbaScanline240()
 {
     if (vCount < 160)
     {
+        // Count drawing, or waiting on the 2D thread, as 2D time
+        BenchSection last = core->benchmark.setSection(BENCH_GPU2D);
         if (thread)
         {
             // Wait for the thread to finish the scanline
@@ -248,6 +247,7 @@ void Gpu::gbaScanline240()
             // Draw the current scanline
             core->gpu2D[0].drawGbaScanline(vCount);
         }
+        core->benchmark.setSection(last);
 
         // Trigger H-blank DMA transfers for visible scanlines
         core->dma[1].trigger(2);
@@ -356,6 +356,8 @@ void Gpu::scanline256()
 {
     if (vCount < 192)
     {
+        // Count drawing, or waiting on the 2D thread, as 2D time
+        BenchSection last = core->benchmark.setSection(BENCH_GPU2D);
         if (thread)
         {
             // Make sure the thread has started before changing the state
@@ -381,6 +383,7 @@ void Gpu::scanline256()
             core->gpu2D[0].drawScanline(vCount);
             core->gpu2D[1].drawScanline(vCount);
         }
+        core->benchmark.setSection(last);
 
         // Trigger H-blank DMA transfers for visible scanlines (ARM9 only)
         core->dma[0].trigger(2);
@@ -412,13 +415,13 @@ void Gpu::scanline256()
                 case 0: // Source A
                 {
                     // Choose from 2D engine A or the 3D engine
-                    // In high-res mode, skip every other pixel when capturing 3D
+                    // When the 3D resolution is scaled, take one pixel from each scaled block when capturing 3D
                     uint32_t *source = (dispCapCnt & BIT(24)) ? core->gpu3DRenderer.getLine(vCount) : core->gpu2D[0].getRawLine();
-                    bool resShift = (Settings::highRes3D && (dispCapCnt & BIT(24)));
+                    int scale = (dispCapCnt & BIT(24)) ? core->gpu3DRenderer.getScale() : 1;
 
                     // Copy a scanline to memory
                     for (int i = 0; i < width; i++)
-                        core->memory.write<uint16_t>(0, base + ((writeOffset + i * 2) & 0x1FFFF), rgb6ToRgb5(source[i << resShift]));
+                        core->memory.write<uint16_t>(0, base + ((writeOffset + i * 2) & 0x1FFFF), rgb6ToRgb5(source[i * scale]));
 
                     break;
                 }
@@ -453,9 +456,9 @@ void Gpu::scanline256()
                     }
 
                     // Choose from 2D engine A or the 3D engine
-                    // In high-res mode, skip every other pixel when capturing 3D
+                    // When the 3D resolution is scaled, take one pixel from each scaled block when capturing 3D
                     uint32_t *source = (dispCapCnt & BIT(24)) ? core->gpu3DRenderer.getLine(vCount) : core->gpu2D[0].getRawLine();
-                    bool resShift = (Settings::highRes3D && (dispCapCnt & BIT(24)));
+                    int scale = (dispCapCnt & BIT(24)) ? core->gpu3DRenderer.getScale() : 1;
 
                     // Get the VRAM source address for the current scanline
                     uint32_t readOffset = ((dispCapCnt & 0x0C000000) >> 11) + vCount * width * 2;
@@ -468,7 +471,7 @@ void Gpu::scanline256()
                     for (int i = 0; i < width; i++)
                     {
                         // Get colors from the two sources
-                        uint16_t c1 = rgb6ToRgb5(source[i << resShift]);
+                        uint16_t c1 = rgb6ToRgb5(source[i * scale]);
                         uint16_t c2 = core->memory.read<uint16_t>(0, base + ((readOffset + i * 2) & 0x1FFFF));
 
                         // Blend the color values
@@ -499,7 +502,9 @@ void Gpu::scanline256()
     if (dirty3D && (core->gpu2D[0].readDispCnt() & BIT(3)) && ((vCount + 48) % 263) < 192)
     {
         if (vCount == 215) dirty3D = BIT(1);
+        BenchSection last = core->benchmark.setSection(BENCH_RENDERER);
         core->gpu3DRenderer.drawScanline((vCount + 48) % 263);
+        core->benchmark.setSection(last);
         if (vCount == 143) dirty3D &= ~BIT(1);
     }
 
@@ -547,7 +552,11 @@ void Gpu::scanline355()
 
             // Swap the buffers of the 3D engine if needed
             if (core->gpu3D.shouldSwap())
+            {
+                BenchSection last = core->benchmark.setSection(BENCH_GPU3D);
                 core->gpu3D.swapBuffers();
+                core->benchmark.setSection(last);
+            }
 
             // Allow up to 2 framebuffers to be queued, to preserve frame pacing if emulation runs ahead
             if (framebuffers.size() < 2)
@@ -575,10 +584,13 @@ void Gpu::scanline355()
                 }
 
                 // Copy the upscaled 3D output to a new buffer if enabled
-                if (Settings::highRes3D && (core->gpu2D[0].readDispCnt() & BIT(3)))
+                int scale = core->gpu3DRenderer.getScale();
+                if (scale > 1 && (core->gpu2D[0].readDispCnt() & BIT(3)))
                 {
-                    buffers.hiRes3D = new uint32_t[256 * 192 * 4];
-                    memcpy(buffers.hiRes3D, core->gpu3DRenderer.getLine(0), 256 * 192 * 4 * sizeof(uint32_t));
+                    int size = 256 * 192 * scale * scale;
+                    buffers.hiRes3D = new uint32_t[size];
+                    memcpy(buffers.hiRes3D, core->gpu3DRenderer.getLine(0), size * sizeof(uint32_t));
+                    buffers.scale3D = scale;
                     buffers.top3D = (powCnt1 & BIT(15));
                 }
 
@@ -705,3 +717,28 @@ void Gpu::writePowCnt1(uint16_t mask, uint16_t value)
     mask &= 0x820F;
     powCnt1 = (powCnt1 & ~mask) | (value & mask);
 }
+
+void Gpu::saveState(FILE *file)
+{
+    // Write state data to the file
+    fwrite(&gbaBlock, sizeof(gbaBlock), 1, file);
+    fwrite(&displayCapture, sizeof(displayCapture), 1, file);
+    fwrite(&dispStat, sizeof(dispStat), 1, file);
+    fwrite(&vCount, sizeof(vCount), 1, file);
+    fwrite(&dispCapCnt, sizeof(dispCapCnt), 1, file);
+    fwrite(&powCnt1, sizeof(powCnt1), 1, file);
+}
+
+void Gpu::loadState(FILE *file)
+{
+    // Read state data from the file
+    fread(&gbaBlock, sizeof(gbaBlock), 1, file);
+    fread(&displayCapture, sizeof(displayCapture), 1, file);
+    fread(&dispStat, sizeof(dispStat), 1, file);
+    fread(&vCount, sizeof(vCount), 1, file);
+    fread(&dispCapCnt, sizeof(dispCapCnt), 1, file);
+    fread(&powCnt1, sizeof(powCnt1), 1, file);
+
+    // Make sure the 3D output is redrawn from the loaded state
+    invalidate3D();
+}
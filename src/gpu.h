@@ -22,6 +22,7 @@
 
 #include <atomic>
 #include <cstdint>
+#include <cstdio>
 #include <thread>
 #include <mutex>
 #include <queue>
@@ -36,6 +37,9 @@ class Gpu
         Gpu(Core *core);
         ~Gpu();
 
+        void saveState(FILE *file);
+        void loadState(FILE *file);
+
         bool getFrame(uint32_t *out, bool gbaCrop);
         void invalidate3D() { dirty3D |= BIT(0); }
 
@@ -60,6 +64,7 @@ class Gpu
         {
             uint32_t *framebuffer = nullptr;
             uint32_t *hiRes3D = nullptr;
+            int scale3D = 1;
             bool top3D = false;
         };
 
@@ -83,6 +88,7 @@ class Gpu
         static uint32_t rgb5ToRgb8(uint32_t color);
         static uint32_t rgb6ToRgb8(uint32_t color);
         static uint16_t rgb6ToRgb5(uint32_t color);
+        static void fillScaled(uint32_t *out, int stride, int scale, uint32_t color);
 
         void drawGbaThreaded();
         void drawThreaded();
@@ -21,7 +21,6 @@
 
 #include "gpu_2d.h"
 #include "core.h"
-#include "settings.h"
 
 Gpu2D::Gpu2D(Core *core, bool engine): core(core), engine(engine)
 {
@@ -493,15 +492,15 @@ template <bool gbaMode> void Gpu2D::drawText(int bg, int line)
     // If 3D is enabled, override BG0 in text mode
     if (!gbaMode && bg == 0 && (dispCnt & BIT(3)))
     {
-        // In high-res 3D mode, skip every other pixel
+        // When the 3D resolution is scaled, take one pixel from each scaled block
         uint32_t *data = core->gpu3DRenderer.getLine(line);
-        bool resShift = Settings::highRes3D;
+        int scale = core->gpu3DRenderer.getScale();
 
         // Draw a scanline of 3D pixels
         for (int i = 0; i < 256; i++)
         {
-            if (data[i << resShift] & 0xFC0000)
-                drawBgPixel(bg, line, i, data[i << resShift]);
+            if (data[i * scale] & 0xFC0000)
+                drawBgPixel(bg, line, i, data[i * scale]);
         }
         return;
     }
@@ -1397,3 +1396,63 @@ void Gpu2D::writeMasterBright(uint16_t mask, uint16_t value)
     mask &= 0xC01F;
     masterBright = (masterBright & ~mask) | (value & mask);
 }
+
+void Gpu2D::saveState(FILE *file)
+{
+    // Write state data to the file
+    fwrite(internalX, sizeof(internalX), 1, file);
+    fwrite(internalY, sizeof(internalY), 1, file);
+    fwrite(winHFlip, sizeof(winHFlip), 1, file);
+    fwrite(winVFlip, sizeof(winVFlip), 1, file);
+    fwrite(&dispCnt, sizeof(dispCnt), 1, file);
+    fwrite(bgCnt, sizeof(bgCnt), 1, file);
+    fwrite(bgHOfs, sizeof(bgHOfs), 1, file);
+    fwrite(bgVOfs, sizeof(bgVOfs), 1, file);
+    fwrite(bgPA, sizeof(bgPA), 1, file);
+    fwrite(bgPB, sizeof(bgPB), 1, file);
+    fwrite(bgPC, sizeof(bgPC), 1, file);
+    fwrite(bgPD, sizeof(bgPD), 1, file);
+    fwrite(bgX, sizeof(bgX), 1, file);
+    fwrite(bgY, sizeof(bgY), 1, file);
+    fwrite(winX1, sizeof(winX1), 1, file);
+    fwrite(winX2, sizeof(winX2), 1, file);
+    fwrite(winY1, sizeof(winY1), 1, file);
+    fwrite(winY2, sizeof(winY2), 1, file);
+    fwrite(&winIn, sizeof(winIn), 1, file);
+    fwrite(&winOut, sizeof(winOut), 1, file);
+    fwrite(&bldCnt, sizeof(bldCnt), 1, file);
+    fwrite(&mosaic, sizeof(mosaic), 1, file);
+    fwrite(&bldAlpha, sizeof(bldAlpha), 1, file);
+    fwrite(&bldY, sizeof(bldY), 1, file);
+    fwrite(&masterBright, sizeof(masterBright), 1, file);
+}
+
+void Gpu2D::loadState(FILE *file)
+{
+    // Read state data from the file
+    fread(internalX, sizeof(internalX), 1, file);
+    fread(internalY, sizeof(internalY), 1, file);
+    fread(winHFlip, sizeof(winHFlip), 1, file);
+    fread(winVFlip, sizeof(winVFlip), 1, file);
+    fread(&dispCnt, sizeof(dispCnt), 1, file);
+    fread(bgCnt, sizeof(bgCnt), 1, file);
+    fread(bgHOfs, sizeof(bgHOfs), 1, file);
+    fread(bgVOfs, sizeof(bgVOfs), 1, file);
+    fread(bgPA, sizeof(bgPA), 1, file);
+    fread(bgPB, sizeof(bgPB), 1, file);
+    fread(bgPC, sizeof(bgPC), 1, file);
+    fread(bgPD, sizeof(bgPD), 1, file);
+    fread(bgX, sizeof(bgX), 1, file);
+    fread(bgY, sizeof(bgY), 1, file);
+    fread(winX1, sizeof(winX1), 1, file);
+    fread(winX2, sizeof(winX2), 1, file);
+    fread(winY1, sizeof(winY1), 1, file);
+    fread(winY2, sizeof(winY2), 1, file);
+    fread(&winIn, sizeof(winIn), 1, file);
+    fread(&winOut, sizeof(winOut), 1, file);
+    fread(&bldCnt, sizeof(bldCnt), 1, file);
+    fread(&mosaic, sizeof(mosaic), 1, file);
+    fread(&bldAlpha, sizeof(bldAlpha), 1, file);
+    fread(&bldY, sizeof(bldY), 1, file);
+    fread(&masterBright, sizeof(masterBright), 1, file);
+}
@@ -17,25 +17,247 @@
     along with NooDS. If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <cstring>
+#include <vector>
 
 #include "gpu_3d.h"
 #include "core.h"
 #include "settings.h"
 
-Matrix Matrix::operator*(Matrix &mtx)
+// Use vector instructions for matrix math where they're available
+// On x86 they're picked at runtime, so builds still work on CPUs without them
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SIMD_X86
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SIMD_NEON
+#endif
+
+// Multiplies a row vector with a 4x4 matrix in 20.12 fixed point, with 64-bit intermediates
+typedef void (*TransformFunc)(const int32_t *vec, const int32_t *mtx, int32_t *out);
+
+// Multiplies vertices given as separate X, Y, and Z arrays with a 4x4 matrix, with W set to 1.0
+// Counts are rounded up to a multiple of 4, so the arrays need room for the extra values
+typedef void (*TransformBatchFunc)(const int32_t *const *in, int32_t *const *out, int count, const int32_t *mtx);
+
+static void transformScalar(const int32_t *vec, const int32_t *mtx, int32_t *out)
 {
-    Matrix result;
+    // Multiply each column separately
+    for (int i = 0; i < 4; i++)
+    {
+        out[i] = ((int64_t)vec[0] * mtx[0 + i] + (int64_t)vec[1] * mtx[4  + i] +
+                  (int64_t)vec[2] * mtx[8 + i] + (int64_t)vec[3] * mtx[12 + i]) >> 12;
+    }
+}
 
-    // Multiply 2 matrices
-    for (int y = 0; y < 4; y++)
+static void transformBatchScalar(const int32_t *const *in, int32_t *const *out, int count, const int32_t *mtx)
+{
+    // Transform each vertex separately
+    for (int i = 0; i < count; i++)
     {
-        for (int x = 0; x < 4; x++)
+        for (int j = 0; j < 4; j++)
         {
-            result.data[y * 4 + x] = ((int64_t)data[y * 4 + 0] * mtx.data[0 + x] + (int64_t)data[y * 4 + 1] * mtx.data[4  + x] +
-                                      (int64_t)data[y * 4 + 2] * mtx.data[8 + x] + (int64_t)data[y * 4 + 3] * mtx.data[12 + x]) >> 12;
+            out[j][i] = ((int64_t)in[0][i] * mtx[0 + j] + (int64_t)in[1][i] * mtx[4 + j] +
+                         (int64_t)in[2][i] * mtx[8 + j] + (int64_t)mtx[12 + j] * (1 << 12)) >> 12;
         }
     }
+}
+
+#ifdef SIMD_X86
+
+__attribute__((target("sse4.1"))) static void transformSse41(const int32_t *vec, const int32_t *mtx, int32_t *out)
+{
+    // Accumulate 64-bit products for the even and odd columns, since SSE can only multiply 2 at a time
+    __m128i even = _mm_setzero_si128(), odd = _mm_setzero_si128();
+    for (int i = 0; i < 4; i++)
+    {
+        __m128i value = _mm_set1_epi32(vec[i]);
+        __m128i row = _mm_loadu_si128((const __m128i*)&mtx[i * 4]);
+        even = _mm_add_epi64(even, _mm_mul_epi32(value, row));
+        odd = _mm_add_epi64(odd, _mm_mul_epi32(value, _mm_srli_epi64(row, 32)));
+    }
+
+    // Shift the results and interleave their low words
+    // Only the low 32 bits are kept, so a logical shift gives the same result as an arithmetic one
+    even = _mm_srli_epi64(even, 12);
+    odd = _mm_slli_epi64(_mm_srli_epi64(odd, 12), 32);
+    _mm_storeu_si128((__m128i*)out, _mm_blend_epi16(even, odd, 0xCC));
+}
+
+__attribute__((target("avx2"))) static void transformAvx2(const int32_t *vec, const int32_t *mtx, int32_t *out)
+{
+    // Multiply 2 matrix rows at a time, for the even and odd columns separately
+    __m256i rows01 = _mm256_loadu_si256((const __m256i*)&mtx[0]);
+    __m256i rows23 = _mm256_loadu_si256((const __m256i*)&mtx[8]);
+    __m256i values01 = _mm256_setr_epi32(vec[0], vec[0], vec[0], vec[0], vec[1], vec[1], vec[1], vec[1]);
+    __m256i values23 = _mm256_setr_epi32(vec[2], vec[2], vec[2], vec[2], vec[3], vec[3], vec[3], vec[3]);
+    __m256i even = _mm256_add_epi64(_mm256_mul_epi32(values01, rows01), _mm256_mul_epi32(values23, rows23));
+    __m256i odd = _mm256_add_epi64(_mm256_mul_epi32(values01, _mm256_srli_epi64(rows01, 32)),
+                                   _mm256_mul_epi32(values23, _mm256_srli_epi64(rows23, 32)));
+
+    // Add the halves together, then shift the results and interleave their low words
+    // Only the low 32 bits are kept, so a logical shift gives the same result as an arithmetic one
+    __m128i evenSum = _mm_add_epi64(_mm256_castsi256_si128(even), _mm256_extracti128_si256(even, 1));
+    __m128i oddSum = _mm_add_epi64(_mm256_castsi256_si128(odd), _mm256_extracti128_si256(odd, 1));
+    evenSum = _mm_srli_epi64(evenSum, 12);
+    oddSum = _mm_slli_epi64(_mm_srli_epi64(oddSum, 12), 32);
+    _mm_storeu_si128((__m128i*)out, _mm_blend_epi16(evenSum, oddSum, 0xCC));
+}
+
+__attribute__((target("sse4.1"))) static void transformBatchSse41(const int32_t *const *in, int32_t *const *out,
+    int count, const int32_t *mtx)
+{
+    for (int i = 0; i < count; i += 4)
+    {
+        // Load 4 vertices, with the odd ones moved into even lanes since SSE can only multiply those
+        __m128i coords[3], oddCoords[3];
+        for (int k = 0; k < 3; k++)
+        {
+            coords[k] = _mm_loadu_si128((const __m128i*)&in[k][i]);
+            oddCoords[k] = _mm_srli_epi64(coords[k], 32);
+        }
+
+        for (int j = 0; j < 4; j++)
+        {
+            // Accumulate 64-bit products for one output coordinate, starting with W times the bottom row
+            __m128i even = _mm_set1_epi64x((int64_t)mtx[12 + j] * (1 << 12)), odd = even;
+            for (int k = 0; k < 3; k++)
+            {
+                __m128i value = _mm_set1_epi32(mtx[k * 4 + j]);
+                even = _mm_add_epi64(even, _mm_mul_epi32(coords[k], value));
+                odd = _mm_add_epi64(odd, _mm_mul_epi32(oddCoords[k], value));
+            }
+
+            // Shift the results and interleave their low words
+            even = _mm_srli_epi64(even, 12);
+            odd = _mm_slli_epi64(_mm_srli_epi64(odd, 12), 32);
+            _mm_storeu_si128((__m128i*)&out[j][i], _mm_blend_epi16(even, odd, 0xCC));
+        }
+    }
+}
+
+__attribute__((target("avx2"))) static void transformBatchAvx2(const int32_t *const *in, int32_t *const *out,
+    int count, const int32_t *mtx)
+{
+    for (int i = 0; i < count; i += 4)
+    {
+        // Load 4 vertices, extended to 64 bits
+        __m256i coords[3];
+        for (int k = 0; k < 3; k++)
+            coords[k] = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)&in[k][i]));
+
+        for (int j = 0; j < 4; j++)
+        {
+            // Accumulate 64-bit products for one output coordinate, starting with W times the bottom row
+            __m256i sum = _mm256_set1_epi64x((int64_t)mtx[12 + j] * (1 << 12));
+            for (int k = 0; k < 3; k++)
+                sum = _mm256_add_epi64(sum, _mm256_mul_epi32(coords[k], _mm256_set1_epi32(mtx[k * 4 + j])));
+
+            // Shift the results and gather their low words
+            sum = _mm256_permutevar8x32_epi32(_mm256_srli_epi64(sum, 12), _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6));
+            _mm_storeu_si128((__m128i*)&out[j][i], _mm256_castsi256_si128(sum));
+        }
+    }
+}
+
+#elif defined(SIMD_NEON)
+
+static void transformNeon(const int32_t *vec, const int32_t *mtx, int32_t *out)
+{
+    // Accumulate 64-bit products for the low and high columns
+    int64x2_t low = vdupq_n_s64(0), high = vdupq_n_s64(0);
+    for (int i = 0; i < 4; i++)
+    {
+        int32x4_t row = vld1q_s32(&mtx[i * 4]);
+        int32x2_t value = vdup_n_s32(vec[i]);
+        low = vmlal_s32(low, vget_low_s32(row), value);
+        high = vmlal_s32(high, vget_high_s32(row), value);
+    }
+
+    // Shift the results and narrow them back to 32 bits
+    vst1q_s32(out, vcombine_s32(vshrn_n_s64(low, 12), vshrn_n_s64(high, 12)));
+}
+
+static void transformBatchNeon(const int32_t *const *in, int32_t *const *out, int count, const int32_t *mtx)
+{
+    for (int i = 0; i < count; i += 4)
+    {
+        // Load 4 vertices
+        int32x4_t coords[3];
+        for (int k = 0; k < 3; k++)
+            coords[k] = vld1q_s32(&in[k][i]);
+
+        for (int j = 0; j < 4; j++)
+        {
+            // Accumulate 64-bit products for one output coordinate, starting with W times the bottom row
+            int64x2_t low = vdupq_n_s64((int64_t)mtx[12 + j] * (1 << 12)), high = low;
+            for (int k = 0; k < 3; k++)
+            {
+                low = vmlal_n_s32(low, vget_low_s32(coords[k]), mtx[k * 4 + j]);
+                high = vmlal_n_s32(high, vget_high_s32(coords[k]), mtx[k * 4 + j]);
+            }
+
+            // Shift the results and narrow them back to 32 bits
+            vst1q_s32(&out[j][i], vcombine_s32(vshrn_n_s64(low, 12), vshrn_n_s64(high, 12)));
+        }
+    }
+}
+
+#endif
+
+static int selectSimd()
+{
+#ifdef SIMD_X86
+    // Use the widest vector instructions the CPU supports
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return 2;
+    if (__builtin_cpu_supports("sse4.1"))
+        return 1;
+#elif defined(SIMD_NEON)
+    // NEON is always there when the compiler targets it
+    return 1;
+#endif
+    return 0;
+}
+
+static TransformFunc selectTransform(int level)
+{
+    // Pick the kernel for a level of vector support
+#ifdef SIMD_X86
+    if (level == 2) return transformAvx2;
+    if (level == 1) return transformSse41;
+#elif defined(SIMD_NEON)
+    if (level == 1) return transformNeon;
+#endif
+    return transformScalar;
+}
+
+static TransformBatchFunc selectTransformBatch(int level)
+{
+    // Pick the batch kernel for a level of vector support
+#ifdef SIMD_X86
+    if (level == 2) return transformBatchAvx2;
+    if (level == 1) return transformBatchSse41;
+#elif defined(SIMD_NEON)
+    if (level == 1) return transformBatchNeon;
+#endif
+    return transformBatchScalar;
+}
+
+static const int simdLevel = selectSimd();
+static const TransformFunc transform = selectTransform(simdLevel);
+static const TransformBatchFunc transformBatch = selectTransformBatch(simdLevel);
+
+Matrix Matrix::operator*(Matrix &mtx)
+{
+    Matrix result;
+
+    // Multiply 2 matrices, one row at a time
+    for (int y = 0; y < 4; y++)
+        transform(&data[y * 4], mtx.data, &result.data[y * 4]);
 
     return result;
 }
@@ -50,10 +272,12 @@ Vector Vector::operator*(Matrix &mtx)
 {
     Vector result;
 
-    // Multiply a vector with a matrix
-    result.x = ((int64_t)x * mtx.data[0] + (int64_t)y * mtx.data[4] + (int64_t)z * mtx.data[8])  >> 12;
-    result.y = ((int64_t)x * mtx.data[1] + (int64_t)y * mtx.data[5] + (int64_t)z * mtx.data[9])  >> 12;
-    result.z = ((int64_t)x * mtx.data[2] + (int64_t)y * mtx.data[6] + (int64_t)z * mtx.data[10]) >> 12;
+    // Multiply a vector with a matrix, leaving out the bottom row
+    int32_t in[4] = { x, y, z, 0 }, out[4];
+    transform(in, mtx.data, out);
+    result.x = out[0];
+    result.y = out[1];
+    result.z = out[2];
 
     return result;
 }
@@ -63,10 +287,12 @@ Vertex Vertex::operator*(Matrix &mtx)
     Vertex result = *this;
 
     // Multiply a vertex with a matrix
-    result.x = ((int64_t)x * mtx.data[0] + (int64_t)y * mtx.data[4] + (int64_t)z * mtx.data[8]  + (int64_t)w * mtx.data[12]) >> 12;
-    result.y = ((int64_t)x * mtx.data[1] + (int64_t)y * mtx.data[5] + (int64_t)z * mtx.data[9]  + (int64_t)w * mtx.data[13]) >> 12;
-    result.z = ((int64_t)x * mtx.data[2] + (int64_t)y * mtx.data[6] + (int64_t)z * mtx.data[10] + (int64_t)w * mtx.data[14]) >> 12;
-    result.w = ((int64_t)x * mtx.data[3] + (int64_t)y * mtx.data[7] + (int64_t)z * mtx.data[11] + (int64_t)w * mtx.data[15]) >> 12;
+    int32_t in[4] = { x, y, z, w }, out[4];
+    transform(in, mtx.data, out);
+    result.x = out[0];
+    result.y = out[1];
+    result.z = out[2];
+    result.w = out[3];
 
     return result;
 }
@@ -175,75 +401,72 @@ bool Gpu3D::clipPolygon(Vertex *unclipped, Vertex *clipped, int *size)
     return clip;
 }
 
+Gpu3D::Gpu3D(Core *core): core(core)
+{
+    // Mark the geometry thread as having no work to start
+    running.store(false);
+    workWrite.store(0);
+    workRead.store(0);
+    threadWaiting.store(false);
+    callerWaiting.store(false);
+}
+
+Gpu3D::~Gpu3D()
+{
+    // Clean up the thread
+    stopThread();
+}
+
 void Gpu3D::runCommand()
 {
+    // Count command processing as geometry time
+    BenchSection last = core->benchmark.setSection(BENCH_GPU3D);
+
     // Fetch the next geometry command
     Entry entry = fifo.front();
     int count = paramCounts[entry.command];
-    std::vector<uint32_t> params;
+    PROFILED(ProfileTimer timer(core->profiler.gxCommands[entry.command]));
+    uint32_t params[32];
 
     // If the command has multiple parameters, fetch them all
     if (count > 1)
     {
-        params.reserve(count);
         for (int i = 0; i < count; i++)
         {
-            params.push_back(fifo.front().param);
+            params[i] = fifo.front().param;
             fifo.pop();
         }
     }
     else
     {
         count = 1;
+        params[0] = entry.param;
         fifo.pop();
     }
 
-    // Execute the geometry command
-    switch (entry.command)
-    {
-        case 0x10: mtxModeCmd(entry.param);       break; // MTX_MODE
-        case 0x11: mtxPushCmd();                  break; // MTX_PUSH
-        case 0x12: mtxPopCmd(entry.param);        break; // MTX_POP
-        case 0x13: mtxStoreCmd(entry.param);      break; // MTX_STORE
-        case 0x14: mtxRestoreCmd(entry.param);    break; // MTX_RESTORE
-        case 0x15: mtxIdentityCmd();              break; // MTX_IDENTITY
-        case 0x16: mtxLoad44Cmd(params);          break; // MTX_LOAD_4x4
-        case 0x17: mtxLoad43Cmd(params);          break; // MTX_LOAD_4x3
-        case 0x18: mtxMult44Cmd(params);          break; // MTX_MULT_4x4
-        case 0x19: mtxMult43Cmd(params);          break; // MTX_MULT_4x3
-        case 0x1A: mtxMult33Cmd(params);          break; // MTX_MULT_3x3
-        case 0x1B: mtxScaleCmd(params);           break; // MTX_SCALE
-        case 0x1C: mtxTransCmd(params);           break; // MTX_TRANS
-        case 0x20: colorCmd(entry.param);         break; // COLOR
-        case 0x21: normalCmd(entry.param);        break; // NORMAL
-        case 0x22: texCoordCmd(entry.param);      break; // TEXCOORD
-        case 0x23: vtx16Cmd(params);              break; // VTX_16
-        case 0x24: vtx10Cmd(entry.param);         break; // VTX_10
-        case 0x25: vtxXYCmd(entry.param);         break; // VTX_XY
-        case 0x26: vtxXZCmd(entry.param);         break; // VTX_XZ
-        case 0x27: vtxYZCmd(entry.param);         break; // VTX_YZ
-        case 0x28: vtxDiffCmd(entry.param);       break; // VTX_DIFF
-        case 0x29: polygonAttrCmd(entry.param);   break; // POLYGON_ATTR
-        case 0x2A: texImageParamCmd(entry.param); break; // TEXIMAGE_PARAM
-        case 0x2B: plttBaseCmd(entry.param);      break; // PLTT_BASE
-        case 0x30: difAmbCmd(entry.param);        break; // DIF_AMB
-        case 0x31: speEmiCmd(entry.param);        break; // SPE_EMI
-        case 0x32: lightVectorCmd(entry.param);   break; // LIGHT_VECTOR
-        case 0x33: lightColorCmd(entry.param);    break; // LIGHT_COLOR
-        case 0x34: shininessCmd(params);          break; // SHININESS
-        case 0x40: beginVtxsCmd(entry.param);     break; // BEGIN_VTXS
-        case 0x41:                                break; // END_VTXS
-        case 0x50: swapBuffersCmd(entry.param);   break; // SWAP_BUFFERS
-        case 0x60: viewportCmd(entry.param);      break; // VIEWPORT
-        case 0x70: boxTestCmd(params);            break; // BOX_TEST
-        case 0x71: posTestCmd(params);            break; // POS_TEST
-        case 0x72: vecTestCmd(entry.param);       break; // VEC_TEST
+    // Update the state the CPU can see as soon as the command is fetched
+    // Executing the rest of it doesn't affect anything visible, so it can be deferred
+    if (entry.command >= 0x10 && entry.command <= 0x14) // Matrix stack commands
+        params[0] = updateStack(entry.command, params[0]);
+    else if (entry.command == 0x50) // SWAP_BUFFERS
+        state = GX_HALTED; // The buffers will be swapped and the engine unhalted on next V-blank
 
-        default:
-        {
-            LOG("Unknown GXFIFO command: 0x%X\n", entry.command);
-            break;
-        }
+    if (Settings::threadedGeometry && (entry.command < 0x70 || entry.command > 0x72))
+    {
+        // Start the geometry thread if it isn't running, and queue the command for it
+        if (!thread)
+            startThread();
+        queueCommand(entry.command, params, count);
+    }
+    else
+    {
+        // Test commands set results for the CPU, so let the thread catch up and run them here
+        // If threaded geometry was turned off, stop the thread now that it's no longer used
+        if (Settings::threadedGeometry)
+            syncThread();
+        else
+            stopThread();
+        executeCommand(entry.command, params);
     }
 
     // On hardware, FIFO entries are moved into a pipe before being executed
@@ -284,18 +507,319 @@ void Gpu3D::runCommand()
         else
             state = GX_IDLE;
     }
+
+    core->benchmark.setSection(last);
+}
+
+
+uint32_t Gpu3D::updateStack(uint8_t command, uint32_t param)
+{
+    // Update the matrix stack status for a command, returning the parameter to execute it with
+    // Pushes and pops get the stack slot to use, or bit 31 set if nothing should be transferred
+    switch (command)
+    {
+        case 0x10: // MTX_MODE
+        {
+            // Track the matrix mode to know which stack is used
+            stackMode = param & 0x00000003;
+            return param;
+        }
+
+        case 0x11: // MTX_PUSH
+        {
+            uint32_t slot = BIT(31);
+            switch (stackMode)
+            {
+                case 0: // Projection stack
+                {
+                    if (!(gxStat & BIT(13)))
+                    {
+                        // Push to the single projection stack slot and increment the pointer
+                        slot = 0;
+                        gxStat |= BIT(13);
+                    }
+                    else
+                    {
+                        // Indicate a matrix stack overflow error
+                        gxStat |= BIT(15);
+                    }
+                    break;
+                }
+
+                case 1: case 2: // Coordinate and directional stacks
+                {
+                    // Get the stack pointer to push to
+                    uint8_t pointer = (gxStat >> 8) & 0x1F;
+
+                    // Indicate a matrix stack overflow error
+                    // Even though the 31st slot exists, it still causes an overflow error
+                    if (pointer >= 30)
+                        gxStat |= BIT(15);
+
+                    // Push to the current stack slot and increment the pointer
+                    if (pointer < 31)
+                    {
+                        slot = pointer;
+                        gxStat += BIT(8);
+                    }
+                    break;
+                }
+
+                case 3: // Texture stack
+                {
+                    // Push to the single texture stack slot
+                    slot = 0;
+                    break;
+                }
+            }
+
+            // Clear the busy bit if no more matrix commands are queued
+            if (--matrixQueue == 0)
+                gxStat &= ~BIT(14);
+            return slot;
+        }
+
+        case 0x12: // MTX_POP
+        {
+            uint32_t slot = BIT(31);
+            switch (stackMode)
+            {
+                case 0: // Projection stack
+                {
+                    if (gxStat & BIT(13))
+                    {
+                        // Pop from the single projection stack slot and decrement the pointer
+                        slot = 0;
+                        gxStat &= ~BIT(13);
+                    }
+                    else
+                    {
+                        // Indicate a matrix stack underflow error
+                        gxStat |= BIT(15);
+                    }
+                    break;
+                }
+
+                case 1: case 2: // Coordinate and directional stacks
+                {
+                    // Get the stack pointer to pop from
+                    uint8_t pointer = ((gxStat >> 8) & 0x1F) - ((int8_t)(param << 2) >> 2);
+
+                    // Indicate a matrix stack underflow or overflow error
+                    // Even though the 31st slot exists, it still causes an overflow error
+                    if (pointer >= 30)
+                        gxStat |= BIT(15);
+
+                    // Pop from the current stack slot and update the pointer
+                    if (pointer < 31)
+                    {
+                        slot = pointer;
+                        gxStat = (gxStat & ~0x1F00) | (pointer << 8);
+                    }
+                    break;
+                }
+
+                case 3: // Texture stack
+                {
+                    // Pop from the single texture stack slot
+                    slot = 0;
+                    break;
+                }
+            }
+
+            // Clear the busy bit if no more matrix commands are queued
+            if (--matrixQueue == 0)
+                gxStat &= ~BIT(14);
+            return slot;
+        }
+
+        default: // MTX_STORE, MTX_RESTORE
+        {
+            // Indicate a matrix stack overflow error when addressing the coordinate and directional stacks
+            // Even though the 31st slot exists, it still causes an overflow error
+            if ((stackMode == 1 || stackMode == 2) && (param & 0x0000001F) == 31)
+                gxStat |= BIT(15);
+            return param;
+        }
+    }
+}
+
+void Gpu3D::executeCommand(uint8_t command, uint32_t *params)
+{
+    // Finish any staged vertices before a command that could affect how they're processed
+    // Vertex, color, normal, and texture coordinate commands only change values that are captured when staging
+    if (stagedCount > 0 && (command < 0x20 || command > 0x28) && command != 0x41)
+        flushVertices();
+
+    // Execute the geometry command
+    switch (command)
+    {
+        case 0x10: mtxModeCmd(params[0]);       break; // MTX_MODE
+        case 0x11: mtxPushCmd(params[0]);       break; // MTX_PUSH
+        case 0x12: mtxPopCmd(params[0]);        break; // MTX_POP
+        case 0x13: mtxStoreCmd(params[0]);      break; // MTX_STORE
+        case 0x14: mtxRestoreCmd(params[0]);    break; // MTX_RESTORE
+        case 0x15: mtxIdentityCmd();            break; // MTX_IDENTITY
+        case 0x16: mtxLoad44Cmd(params);        break; // MTX_LOAD_4x4
+        case 0x17: mtxLoad43Cmd(params);        break; // MTX_LOAD_4x3
+        case 0x18: mtxMult44Cmd(params);        break; // MTX_MULT_4x4
+        case 0x19: mtxMult43Cmd(params);        break; // MTX_MULT_4x3
+        case 0x1A: mtxMult33Cmd(params);        break; // MTX_MULT_3x3
+        case 0x1B: mtxScaleCmd(params);         break; // MTX_SCALE
+        case 0x1C: mtxTransCmd(params);         break; // MTX_TRANS
+        case 0x20: colorCmd(params[0]);         break; // COLOR
+        case 0x21: normalCmd(params[0]);        break; // NORMAL
+        case 0x22: texCoordCmd(params[0]);      break; // TEXCOORD
+        case 0x23: vtx16Cmd(params);            break; // VTX_16
+        case 0x24: vtx10Cmd(params[0]);         break; // VTX_10
+        case 0x25: vtxXYCmd(params[0]);         break; // VTX_XY
+        case 0x26: vtxXZCmd(params[0]);         break; // VTX_XZ
+        case 0x27: vtxYZCmd(params[0]);         break; // VTX_YZ
+        case 0x28: vtxDiffCmd(params[0]);       break; // VTX_DIFF
+        case 0x29: polygonAttrCmd(params[0]);   break; // POLYGON_ATTR
+        case 0x2A: texImageParamCmd(params[0]); break; // TEXIMAGE_PARAM
+        case 0x2B: plttBaseCmd(params[0]);      break; // PLTT_BASE
+        case 0x30: difAmbCmd(params[0]);        break; // DIF_AMB
+        case 0x31: speEmiCmd(params[0]);        break; // SPE_EMI
+        case 0x32: lightVectorCmd(params[0]);   break; // LIGHT_VECTOR
+        case 0x33: lightColorCmd(params[0]);    break; // LIGHT_COLOR
+        case 0x34: shininessCmd(params);        break; // SHININESS
+        case 0x40: beginVtxsCmd(params[0]);     break; // BEGIN_VTXS
+        case 0x41:                              break; // END_VTXS
+        case 0x50: swapBuffersCmd(params[0]);   break; // SWAP_BUFFERS
+        case 0x60: viewportCmd(params[0]);      break; // VIEWPORT
+        case 0x70: boxTestCmd(params);          break; // BOX_TEST
+        case 0x71: posTestCmd(params);          break; // POS_TEST
+        case 0x72: vecTestCmd(params[0]);       break; // VEC_TEST
+
+        default:
+        {
+            LOG("Unknown GXFIFO command: 0x%X\n", command);
+            break;
+        }
+    }
+}
+
+void Gpu3D::queueCommand(uint8_t command, uint32_t *params, int count)
+{
+    // Wait for space if the thread has fallen too far behind
+    waitThread(count + 1);
+
+    // Write the command with its parameter count, followed by the parameters
+    uint32_t write = workWrite.load();
+    workQueue[write++ & WORK_MASK] = command | (count << 8);
+    for (int i = 0; i < count; i++)
+        workQueue[write++ & WORK_MASK] = params[i];
+
+    // Signal that the command is ready for the thread, waking it up if it's sleeping
+    workWrite.store(write);
+    if (threadWaiting.load())
+    {
+        std::lock_guard<std::mutex> guard(workMutex);
+        workReady.notify_one();
+    }
+}
+
+void Gpu3D::runThreaded()
+{
+    uint32_t params[32];
+
+    while (running)
+    {
+        // Wait until a command is queued, spinning briefly before sleeping
+        uint32_t read = workRead.load();
+        for (int i = 0; read == workWrite.load(); i++)
+        {
+            if (!running) return;
+            if (i < WAIT_SPINS)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(workMutex);
+            threadWaiting.store(true);
+            workReady.wait(lock, [&] { return read != workWrite.load() || !running; });
+            threadWaiting.store(false);
+        }
+
+        // Read the command and its parameters
+        uint32_t header = workQueue[read++ & WORK_MASK];
+        int count = header >> 8;
+        for (int i = 0; i < count; i++)
+            params[i] = workQueue[read++ & WORK_MASK];
+
+        // Execute the command, then signal that its space is free, waking up the caller if it's sleeping
+        executeCommand(header, params);
+        workRead.store(read);
+        if (callerWaiting.load())
+        {
+            std::lock_guard<std::mutex> guard(workMutex);
+            workDone.notify_one();
+        }
+    }
+}
+
+void Gpu3D::startThread()
+{
+    // Start a thread for executing geometry commands
+    running.store(true);
+    thread = new std::thread(&Gpu3D::runThreaded, this);
+}
+
+void Gpu3D::stopThread()
+{
+    if (!thread) return;
+
+    // Let the thread finish its commands, then wake it up to stop it
+    syncThread();
+    {
+        std::lock_guard<std::mutex> guard(workMutex);
+        running.store(false);
+    }
+    workReady.notify_one();
+    thread->join();
+    delete thread;
+    thread = nullptr;
+}
+
+void Gpu3D::syncThread()
+{
+    // Wait for the thread to execute every queued command, so its state can be accessed
+    waitThread(WORK_MASK + 1);
+}
+
+void Gpu3D::waitThread(uint32_t words)
+{
+    // Wait until the queue has space for a number of words, which means it's empty if all of them are needed
+    uint32_t limit = WORK_MASK + 1 - words;
+    for (int i = 0; workWrite.load() - workRead.load() > limit; i++)
+    {
+        // Spin briefly in case the thread is almost done, then sleep until it makes enough progress
+        if (i < WAIT_SPINS)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(workMutex);
+        callerWaiting.store(true);
+        workDone.wait(lock, [&] { return workWrite.load() - workRead.load() <= limit; });
+        callerWaiting.store(false);
+        break;
+    }
 }
 
 void Gpu3D::processVertices()
 {
-    // Scale the viewport based on the high-res 3D setting
-    bool resShift = Settings::highRes3D;
-    uint16_t x = viewport[0] << resShift;
-    uint16_t y = viewport[1] << resShift;
-    uint16_t w = viewport[2] << resShift;
-    uint16_t h = viewport[3] << resShift;
-    uint16_t xMask = (0x200 << resShift) - 1;
-    uint16_t yMask = (0x100 << resShift) - 1;
+    // Scale the viewport based on the 3D resolution scale
+    int scale = Settings::getScale3D();
+    uint16_t x = viewport[0] * scale;
+    uint16_t y = viewport[1] * scale;
+    uint16_t w = viewport[2] * scale;
+    uint16_t h = viewport[3] * scale;
+    int64_t xSize = 0x200 * scale;
+    int64_t ySize = 0x100 * scale;
 
     // Normalize and scale new vertices to the viewport
     // X coordinates are 9-bit and Y coordinates are 8-bit; invalid viewports can cause wraparound
@@ -304,8 +828,10 @@ void Gpu3D::processVertices()
     {
         if (verticesIn[i].w != 0)
         {
-            verticesIn[i].x = (( (int64_t)verticesIn[i].x + verticesIn[i].w) * w / (verticesIn[i].w * 2) + x) & xMask;
-            verticesIn[i].y = ((-(int64_t)verticesIn[i].y + verticesIn[i].w) * h / (verticesIn[i].w * 2) + y) & yMask;
+            int64_t vx = ( (int64_t)verticesIn[i].x + verticesIn[i].w) * w / (verticesIn[i].w * 2) + x;
+            int64_t vy = (-(int64_t)verticesIn[i].y + verticesIn[i].w) * h / (verticesIn[i].w * 2) + y;
+            verticesIn[i].x = ((vx % xSize) + xSize) % xSize;
+            verticesIn[i].y = ((vy % ySize) + ySize) % ySize;
             verticesIn[i].z = (((((int64_t)verticesIn[i].z << 14) / verticesIn[i].w) + 0x3FFF) << 9);
         }
     }
@@ -317,6 +843,12 @@ void Gpu3D::processVertices()
 
 void Gpu3D::swapBuffers()
 {
+    // Let the geometry thread finish the frame's commands; it stays parked until the next frame's commands
+    syncThread();
+
+    // Finish any staged vertices
+    flushVertices();
+
     // Process final vertices and reset the count
     processVertices();
     processCount = 0;
@@ -372,13 +904,19 @@ void Gpu3D::swapBuffers()
     }
 }
 
-void Gpu3D::addVertex()
+void Gpu3D::stageVertex()
 {
-    if (vertexCountIn >= 6144) return;
+    // Make room for the new vertex if needed
+    if (stagedCount == 256)
+        flushVertices();
 
-    // Set the new vertex
-    verticesIn[vertexCountIn] = savedVertex;
-    verticesIn[vertexCountIn].w = 1 << 12;
+    // Stage the vertex's coordinates and color
+    stagedX[stagedCount] = savedVertex.x;
+    stagedY[stagedCount] = savedVertex.y;
+    stagedZ[stagedCount] = savedVertex.z;
+    stagedS[stagedCount] = savedVertex.s;
+    stagedT[stagedCount] = savedVertex.t;
+    stagedColor[stagedCount] = savedVertex.color;
 
     // Transform the texture coordinates
     if (textureCoordMode == 3)
@@ -389,22 +927,59 @@ void Gpu3D::addVertex()
         matrix.data[13] = (int32_t)t << 12;
 
         // Multiply the vertex with the texture matrix
-        Vertex vertex = verticesIn[vertexCountIn] * matrix;
+        Vertex vertex = savedVertex;
+        vertex.w = 1 << 12;
+        vertex = vertex * matrix;
 
         // Save the transformed coordinates
-        verticesIn[vertexCountIn].s = vertex.x >> 12;
-        verticesIn[vertexCountIn].t = vertex.y >> 12;
+        stagedS[stagedCount] = vertex.x >> 12;
+        stagedT[stagedCount] = vertex.y >> 12;
     }
 
+    stagedCount++;
+}
+
+void Gpu3D::flushVertices()
+{
+    if (stagedCount == 0) return;
+
     // Update the clip matrix if necessary
+    // Anything that changes it flushes first, so it's the same for every staged vertex
     if (clipDirty)
     {
         clip = coordinate * projection;
         clipDirty = false;
     }
 
-    // Transform the vertex
-    verticesIn[vertexCountIn] = verticesIn[vertexCountIn] * clip;
+    // Transform the staged vertices in one batch
+    int32_t x[260], y[260], z[260], w[260];
+    const int32_t *in[] = { stagedX, stagedY, stagedZ };
+    int32_t *out[] = { x, y, z, w };
+    transformBatch(in, out, (stagedCount + 3) & ~3, clip.data);
+
+    // Add the transformed vertices in order, assembling polygons as they complete
+    for (int i = 0; i < stagedCount; i++)
+    {
+        Vertex vertex;
+        vertex.x = x[i];
+        vertex.y = y[i];
+        vertex.z = z[i];
+        vertex.w = w[i];
+        vertex.s = stagedS[i];
+        vertex.t = stagedT[i];
+        vertex.color = stagedColor[i];
+        addVertex(vertex);
+    }
+
+    stagedCount = 0;
+}
+
+void Gpu3D::addVertex(Vertex &vertex)
+{
+    if (vertexCountIn >= 6144) return;
+
+    // Set the new vertex
+    verticesIn[vertexCountIn] = vertex;
 
     // Move to the next vertex
     vertexCountIn++;
@@ -617,44 +1192,26 @@ void Gpu3D::mtxModeCmd(uint32_t param)
     matrixMode = param & 0x00000003;
 }
 
-void Gpu3D::mtxPushCmd()
+void Gpu3D::mtxPushCmd(uint32_t param)
 {
+    // Skip the push if the stack overflowed; the slot was chosen when the stack status was updated
+    if (param & BIT(31)) return;
+
     // Push the current matrix onto a stack
     switch (matrixMode)
     {
         case 0: // Projection stack
         {
-            if (!(gxStat & BIT(13)))
-            {
-                // Push to the single projection stack slot and increment the pointer
-                projectionStack = projection;
-                gxStat |= BIT(13);
-            }
-            else
-            {
-                // Indicate a matrix stack overflow error
-                gxStat |= BIT(15);
-            }
+            // Push to the single projection stack slot
+            projectionStack = projection;
             break;
         }
 
         case 1: case 2: // Coordinate and directional stacks
         {
-            // Get the stack pointer to push to
-            uint8_t pointer = (gxStat >> 8) & 0x1F;
-
-            // Indicate a matrix stack overflow error
-            // Even though the 31st slot exists, it still causes an overflow error
-            if (pointer >= 30)
-                gxStat |= BIT(15);
-
-            // Push to the current coordinate and directional stack slots and increment the pointer
-            if (pointer < 31)
-            {
-                coordinateStack[pointer] = coordinate;
-                directionStack[pointer] = direction;
-                gxStat += BIT(8);
-            }
+            // Push to the current coordinate and directional stack slots
+            coordinateStack[param] = coordinate;
+            directionStack[param] = direction;
             break;
         }
 
@@ -665,52 +1222,30 @@ void Gpu3D::mtxPushCmd()
             break;
         }
     }
-
-    // Clear the busy bit if no more matrix commands are queued
-    if (--matrixQueue == 0)
-        gxStat &= ~BIT(14);
 }
 
 void Gpu3D::mtxPopCmd(uint32_t param)
 {
+    // Skip the pop if the stack underflowed; the slot was chosen when the stack status was updated
+    if (param & BIT(31)) return;
+
     // Pop a matrix from a stack
     switch (matrixMode)
     {
         case 0: // Projection stack
         {
-            if (gxStat & BIT(13))
-            {
-                // Pop from the single projection stack slot and decrement the pointer
-                gxStat &= ~BIT(13);
-                projection = projectionStack;
-                clipDirty = true;
-            }
-            else
-            {
-                // Indicate a matrix stack underflow error
-                gxStat |= BIT(15);
-            }
+            // Pop from the single projection stack slot
+            projection = projectionStack;
+            clipDirty = true;
             break;
         }
 
         case 1: case 2: // Coordinate and directional stacks
         {
-            // Get the stack pointer to pop from
-            uint8_t pointer = ((gxStat >> 8) & 0x1F) - ((int8_t)(param << 2) >> 2);
-
-            // Indicate a matrix stack underflow or overflow error
-            // Even though the 31st slot exists, it still causes an overflow error
-            if (pointer >= 30)
-                gxStat |= BIT(15);
-
-            // Pop from the current coordinate and directional stack slots and update the pointer
-            if (pointer < 31)
-            {
-                gxStat = (gxStat & ~0x1F00) | (pointer << 8);
-                coordinate = coordinateStack[pointer];
-                direction = directionStack[pointer];
-                clipDirty = true;
-            }
+            // Pop from the current coordinate and directional stack slots
+            coordinate = coordinateStack[param];
+            direction = directionStack[param];
+            clipDirty = true;
             break;
         }
 
@@ -721,10 +1256,6 @@ void Gpu3D::mtxPopCmd(uint32_t param)
             break;
         }
     }
-
-    // Clear the busy bit if no more matrix commands are queued
-    if (--matrixQueue == 0)
-        gxStat &= ~BIT(14);
 }
 
 void Gpu3D::mtxStoreCmd(uint32_t param)
@@ -741,14 +1272,8 @@ void Gpu3D::mtxStoreCmd(uint32_t param)
 
         case 1: case 2: // Coordinate and directional stacks
         {
-            // Get the stack address to store to
-            int address = param & 0x0000001F;
-
-            // Indicate a matrix stack overflow error
-            // Even though the 31st slot exists, it still causes an overflow error
-            if (address == 31) gxStat |= BIT(15);
-
             // Store to the current coordinate and directional stack slots
+            int address = param & 0x0000001F;
             coordinateStack[address] = coordinate;
             directionStack[address] = direction;
             break;
@@ -778,19 +1303,13 @@ void Gpu3D::mtxRestoreCmd(uint32_t param)
 
         case 1: case 2: // Coordinate and directional stacks
         {
-            // Get the stack address to store to
-            int address = param & 0x0000001F;
-
-            // Indicate a matrix stack overflow error
-            // Even though the 31st slot exists, it still causes an overflow error
-            if (address == 31) gxStat |= BIT(15);
-
             // Restore from the current coordinate and directional stack slots
+            int address = param & 0x0000001F;
             coordinate = coordinateStack[address];
             direction = directionStack[address];
             clipDirty = true;
             break;
-       }
+        }
 
         case 3: // Texture stack
         {
@@ -836,7 +1355,7 @@ void Gpu3D::mtxIdentityCmd()
     }
 }
 
-void Gpu3D::mtxLoad44Cmd(std::vector<uint32_t> &params)
+void Gpu3D::mtxLoad44Cmd(uint32_t *params)
 {
     // Convert the parameters to a 4x4 matrix
     Matrix matrix = *(Matrix*)&params[0];
@@ -874,7 +1393,7 @@ void Gpu3D::mtxLoad44Cmd(std::vector<uint32_t> &params)
     }
 }
 
-void Gpu3D::mtxLoad43Cmd(std::vector<uint32_t> &params)
+void Gpu3D::mtxLoad43Cmd(uint32_t *params)
 {
     // Convert the parameters to a 4x3 matrix
     Matrix matrix;
@@ -914,7 +1433,7 @@ void Gpu3D::mtxLoad43Cmd(std::vector<uint32_t> &params)
     }
 }
 
-void Gpu3D::mtxMult44Cmd(std::vector<uint32_t> &params)
+void Gpu3D::mtxMult44Cmd(uint32_t *params)
 {
     // Convert the parameters to a 4x4 matrix
     Matrix matrix = *(Matrix*)&params[0];
@@ -952,7 +1471,7 @@ void Gpu3D::mtxMult44Cmd(std::vector<uint32_t> &params)
     }
 }
 
-void Gpu3D::mtxMult43Cmd(std::vector<uint32_t> &params)
+void Gpu3D::mtxMult43Cmd(uint32_t *params)
 {
     // Convert the parameters to a 4x3 matrix
     Matrix matrix;
@@ -992,7 +1511,7 @@ void Gpu3D::mtxMult43Cmd(std::vector<uint32_t> &params)
     }
 }
 
-void Gpu3D::mtxMult33Cmd(std::vector<uint32_t> &params)
+void Gpu3D::mtxMult33Cmd(uint32_t *params)
 {
     // Convert the parameters to a 3x3 matrix
     Matrix matrix;
@@ -1032,7 +1551,7 @@ void Gpu3D::mtxMult33Cmd(std::vector<uint32_t> &params)
     }
 }
 
-void Gpu3D::mtxScaleCmd(std::vector<uint32_t> &params)
+void Gpu3D::mtxScaleCmd(uint32_t *params)
 {
     // Convert the parameters to a scale matrix
     Matrix matrix;
@@ -1064,7 +1583,7 @@ void Gpu3D::mtxScaleCmd(std::vector<uint32_t> &params)
     }
 }
 
-void Gpu3D::mtxTransCmd(std::vector<uint32_t> &params)
+void Gpu3D::mtxTransCmd(uint32_t *params)
 {
     // Convert the parameters to a translation matrix
     Matrix matrix;
@@ -1215,14 +1734,14 @@ void Gpu3D::texCoordCmd(uint32_t param)
     }
 }
 
-void Gpu3D::vtx16Cmd(std::vector<uint32_t> &params)
+void Gpu3D::vtx16Cmd(uint32_t *params)
 {
     // Set the X, Y, and Z coordinates
     savedVertex.x = (int16_t)(params[0] >>  0);
     savedVertex.y = (int16_t)(params[0] >> 16);
     savedVertex.z = (int16_t)(params[1]);
 
-    addVertex();
+    stageVertex();
 }
 
 void Gpu3D::vtx10Cmd(uint32_t param)
@@ -1232,7 +1751,7 @@ void Gpu3D::vtx10Cmd(uint32_t param)
     savedVertex.y = (int16_t)((param & 0x000FFC00) >> 4);
     savedVertex.z = (int16_t)((param & 0x3FF00000) >> 14);
 
-    addVertex();
+    stageVertex();
 }
 
 void Gpu3D::vtxXYCmd(uint32_t param)
@@ -1241,7 +1760,7 @@ void Gpu3D::vtxXYCmd(uint32_t param)
     savedVertex.x = (int16_t)(param >>  0);
     savedVertex.y = (int16_t)(param >> 16);
 
-    addVertex();
+    stageVertex();
 }
 
 void Gpu3D::vtxXZCmd(uint32_t param)
@@ -1250,7 +1769,7 @@ void Gpu3D::vtxXZCmd(uint32_t param)
     savedVertex.x = (int16_t)(param >>  0);
     savedVertex.z = (int16_t)(param >> 16);
 
-    addVertex();
+    stageVertex();
 }
 
 void Gpu3D::vtxYZCmd(uint32_t param)
@@ -1259,7 +1778,7 @@ void Gpu3D::vtxYZCmd(uint32_t param)
     savedVertex.y = (int16_t)(param >>  0);
     savedVertex.z = (int16_t)(param >> 16);
 
-    addVertex();
+    stageVertex();
 }
 
 void Gpu3D::vtxDiffCmd(uint32_t param)
@@ -1269,7 +1788,7 @@ void Gpu3D::vtxDiffCmd(uint32_t param)
     savedVertex.y += ((int16_t)((param & 0x000FFC00) >>  4) / 8) >> 3;
     savedVertex.z += ((int16_t)((param & 0x3FF00000) >> 14) / 8) >> 3;
 
-    addVertex();
+    stageVertex();
 }
 
 void Gpu3D::polygonAttrCmd(uint32_t param)
@@ -1343,7 +1862,7 @@ void Gpu3D::lightColorCmd(uint32_t param)
     lightColor[param >> 30] = rgb5ToRgb6(param);
 }
 
-void Gpu3D::shininessCmd(std::vector<uint32_t> &params)
+void Gpu3D::shininessCmd(uint32_t *params)
 {
     // Set the values of the specular reflection shininess table
     for (int i = 0; i < 32; i++)
@@ -1384,11 +1903,8 @@ void Gpu3D::beginVtxsCmd(uint32_t param)
 void Gpu3D::swapBuffersCmd(uint32_t param)
 {
     // Set the W-buffering toggle
+    // The engine is halted when the command is fetched, so it stays in sync with the CPU
     savedPolygon.wBuffer = param & BIT(1);
-
-    // Halt the geometry engine
-    // The buffers will be swapped and the engine unhalted on next V-blank
-    state = GX_HALTED;
 }
 
 void Gpu3D::viewportCmd(uint32_t param)
@@ -1400,7 +1916,7 @@ void Gpu3D::viewportCmd(uint32_t param)
     viewportNext[3] = ((191 - ((param >> 8) & 0xFF)) - viewportNext[1] + 1) & 0xFF;
 }
 
-void Gpu3D::boxTestCmd(std::vector<uint32_t> &params)
+void Gpu3D::boxTestCmd(uint32_t *params)
 {
     // Store the parameters (X-pos, Y-pos, Z-pos, width, height, depth)
     int16_t boxTestCoords[6] =
@@ -1480,7 +1996,7 @@ void Gpu3D::boxTestCmd(std::vector<uint32_t> &params)
     gxStat &= ~BIT(1);
 }
 
-void Gpu3D::posTestCmd(std::vector<uint32_t> &params)
+void Gpu3D::posTestCmd(uint32_t *params)
 {
     // Set the X, Y, and Z coordinates, overwriting the saved vertex
     savedVertex.x = (int16_t)(params[0] >>  0);
@@ -1529,33 +2045,25 @@ void Gpu3D::vecTestCmd(uint32_t param)
 
 void Gpu3D::addEntry(Entry entry)
 {
-    if (fifo.size() - pipeSize == 0 && pipeSize < 4)
-    {
-        // Move data directly into the pipe if the FIFO is empty and the pipe isn't full
-        fifo.push(entry);
-        pipeSize++;
+    // Add an entry and update the FIFO for it
+    queueEntry(entry);
+    updateFifo();
+}
 
-        // Update the FIFO status
-        gxStat |= BIT(27); // Commands executing
-    }
-    else
+void Gpu3D::queueEntry(Entry entry)
+{
+    // Drop the entry if the FIFO somehow overflows the whole buffer
+    if (fifo.full())
     {
-        // If the FIFO is full, halt the CPU until space is free
-        if (fifo.size() - pipeSize >= 256)
-            core->interpreter[0].halt(1);
-
-        // Move data into the FIFO
-        fifo.push(entry);
-
-        // Update the FIFO status
-        gxStat = (gxStat & ~0x01FF0000) | ((fifo.size() - pipeSize) << 16); // FIFO entries
-        gxStat &= ~BIT(26); // FIFO not empty
-
-        // If the FIFO is half full or more, disable GXFIFO DMA transfers
-        if (fifo.size() - pipeSize >= 128 && (gxStat & BIT(25)))
-            gxStat &= ~BIT(25);
+        LOG("GXFIFO overflow, dropping command 0x%X\n", entry.command);
+        return;
     }
 
+    // Move data into the pipe if the FIFO is empty and the pipe isn't full, or into the FIFO otherwise
+    if (fifo.size() - pipeSize == 0 && pipeSize < 4)
+        pipeSize++;
+    fifo.push(entry);
+
     switch (entry.command)
     {
         case 0x11: case 0x12: // MTX_PUSH, MTX_POP
@@ -1570,6 +2078,28 @@ void Gpu3D::addEntry(Entry entry)
             gxStat |= BIT(0);
             break;
     }
+}
+
+void Gpu3D::updateFifo()
+{
+    // Update the FIFO status after entries were added
+    // Commands don't run while entries are added, so doing this once after a batch works the same as after each one
+    size_t entries = fifo.size() - pipeSize;
+    gxStat |= BIT(27); // Commands executing
+
+    if (entries > 0)
+    {
+        // If the FIFO overflowed, halt the CPU until space is free
+        if (entries > 256)
+            core->interpreter[0].halt(1);
+
+        gxStat = (gxStat & ~0x01FF0000) | (entries << 16); // FIFO entries
+        gxStat &= ~BIT(26); // FIFO not empty
+
+        // If the FIFO is half full or more, disable GXFIFO DMA transfers
+        if (entries >= 128 && (gxStat & BIT(25)))
+            gxStat &= ~BIT(25);
+    }
 
     // Start executing commands if one is ready
     if (state == GX_IDLE && fifo.size() >= paramCounts[fifo.front().command])
@@ -1579,18 +2109,18 @@ void Gpu3D::addEntry(Entry entry)
     }
 }
 
-void Gpu3D::writeGxFifo(uint32_t mask, uint32_t value)
+void Gpu3D::unpackGxFifo(uint32_t value)
 {
     if (gxFifo == 0)
     {
         // Read new packed commands
-        gxFifo = value & mask;
+        gxFifo = value;
     }
     else
     {
         // Add a command parameter
-        Entry entry(gxFifo, value & mask);
-        addEntry(entry);
+        Entry entry(gxFifo, value);
+        queueEntry(entry);
         gxFifoCount++;
 
         // Move to the next command once all parameters have been sent
@@ -1605,11 +2135,26 @@ void Gpu3D::writeGxFifo(uint32_t mask, uint32_t value)
     while (gxFifo != 0 && paramCounts[gxFifo & 0xFF] == 0)
     {
         Entry entry(gxFifo, 0);
-        addEntry(entry);
+        queueEntry(entry);
         gxFifo >>= 8;
     }
 }
 
+void Gpu3D::writeGxFifo(uint32_t mask, uint32_t value)
+{
+    // Unpack a word written to the GXFIFO register
+    unpackGxFifo(value & mask);
+    updateFifo();
+}
+
+void Gpu3D::writeGxFifo(uint32_t *values, int count)
+{
+    // Unpack a batch of words sent to the GXFIFO register, updating the FIFO once at the end
+    for (int i = 0; i < count; i++)
+        unpackGxFifo(values[i]);
+    updateFifo();
+}
+
 void Gpu3D::writeMtxMode(uint32_t mask, uint32_t value)
 {
     // Add an entry to the FIFO
@@ -1882,12 +2427,17 @@ void Gpu3D::writeGxStat(uint32_t mask, uint32_t value)
 
 uint32_t Gpu3D::readRamCount()
 {
-    // Read from the RAM_COUNT register
+    // Read from the RAM_COUNT register, with any queued commands and staged vertices added first
+    syncThread();
+    flushVertices();
     return (vertexCountIn << 16) | polygonCountIn;
 }
 
 uint32_t Gpu3D::readClipMtxResult(int index)
 {
+    // Make sure queued commands have updated the matrices
+    syncThread();
+
     // Update the clip matrix if necessary
     if (clipDirty)
     {
@@ -1901,6 +2451,248 @@ uint32_t Gpu3D::readClipMtxResult(int index)
 
 uint32_t Gpu3D::readVecMtxResult(int index)
 {
-    // Read from one of the VECMTX_RESULT registers
+    // Read from one of the VECMTX_RESULT registers, once queued commands have updated the matrix
+    syncThread();
     return direction.data[(index / 3) * 4 + index % 3];
 }
+
+void Gpu3D::saveState(FILE *file)
+{
+    // Finish any queued commands and staged vertices so they're included in the buffers
+    syncThread();
+    flushVertices();
+
+    // Write the FIFO entries to the file
+    uint32_t count = fifo.size();
+    fwrite(&count, sizeof(count), 1, file);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        fwrite(&fifo.at(i).command, sizeof(uint8_t), 1, file);
+        fwrite(&fifo.at(i).param, sizeof(uint32_t), 1, file);
+    }
+
+    // Write the vertex and polygon buffers to the file, storing vertex pointers as indices
+    bool bufferIn = (verticesIn == vertices2);
+    fwrite(&bufferIn, sizeof(bufferIn), 1, file);
+    for (int i = 0; i < 2; i++)
+    {
+        Vertex *vertices = i ? verticesOut : verticesIn;
+        _Polygon *polygons = i ? polygonsOut : polygonsIn;
+        int vtxCount = i ? vertexCountOut : vertexCountIn;
+        int polyCount = i ? polygonCountOut : polygonCountIn;
+        fwrite(&vtxCount, sizeof(vtxCount), 1, file);
+        fwrite(vertices, sizeof(Vertex), vtxCount, file);
+        fwrite(&polyCount, sizeof(polyCount), 1, file);
+        for (int j = 0; j < polyCount; j++)
+        {
+            _Polygon polygon = polygons[j];
+            polygon.vertices = (Vertex*)(polygon.vertices - vertices);
+            fwrite(&polygon, sizeof(polygon), 1, file);
+        }
+    }
+
+    // Write the values that are checked against the buffers on load
+    // The saved polygon goes without its vertex pointer, which isn't used between polygons
+    // This keeps states identical across a load, so consecutive states compare well for rewinding
+    _Polygon polygon = savedPolygon;
+    polygon.vertices = nullptr;
+    fwrite(&state, sizeof(state), 1, file);
+    fwrite(&pipeSize, sizeof(pipeSize), 1, file);
+    fwrite(&testQueue, sizeof(testQueue), 1, file);
+    fwrite(&matrixQueue, sizeof(matrixQueue), 1, file);
+    fwrite(&processCount, sizeof(processCount), 1, file);
+    fwrite(&vertexCount, sizeof(vertexCount), 1, file);
+    fwrite(&polygon, sizeof(polygon), 1, file);
+
+    // Write the remaining state data to the file
+    fwrite(&matrixMode, sizeof(matrixMode), 1, file);
+    fwrite(&clipDirty, sizeof(clipDirty), 1, file);
+    fwrite(&projection, sizeof(projection), 1, file);
+    fwrite(&projectionStack, sizeof(projectionStack), 1, file);
+    fwrite(&coordinate, sizeof(coordinate), 1, file);
+    fwrite(coordinateStack, sizeof(coordinateStack), 1, file);
+    fwrite(&direction, sizeof(direction), 1, file);
+    fwrite(directionStack, sizeof(directionStack), 1, file);
+    fwrite(&texture, sizeof(texture), 1, file);
+    fwrite(&textureStack, sizeof(textureStack), 1, file);
+    fwrite(&clip, sizeof(clip), 1, file);
+    fwrite(&savedVertex, sizeof(savedVertex), 1, file);
+    fwrite(&s, sizeof(s), 1, file);
+    fwrite(&t, sizeof(t), 1, file);
+    fwrite(&clockwise, sizeof(clockwise), 1, file);
+    fwrite(&polygonType, sizeof(polygonType), 1, file);
+    fwrite(&textureCoordMode, sizeof(textureCoordMode), 1, file);
+    fwrite(&polygonAttr, sizeof(polygonAttr), 1, file);
+    fwrite(&enabledLights, sizeof(enabledLights), 1, file);
+    fwrite(&renderBack, sizeof(renderBack), 1, file);
+    fwrite(&renderFront, sizeof(renderFront), 1, file);
+    fwrite(&diffuseColor, sizeof(diffuseColor), 1, file);
+    fwrite(&ambientColor, sizeof(ambientColor), 1, file);
+    fwrite(&specularColor, sizeof(specularColor), 1, file);
+    fwrite(&emissionColor, sizeof(emissionColor), 1, file);
+    fwrite(&shininessEnabled, sizeof(shininessEnabled), 1, file);
+    fwrite(lightVector, sizeof(lightVector), 1, file);
+    fwrite(halfVector, sizeof(halfVector), 1, file);
+    fwrite(lightColor, sizeof(lightColor), 1, file);
+    fwrite(shininess, sizeof(shininess), 1, file);
+    fwrite(viewport, sizeof(viewport), 1, file);
+    fwrite(viewportNext, sizeof(viewportNext), 1, file);
+    fwrite(&gxFifo, sizeof(gxFifo), 1, file);
+    fwrite(&gxStat, sizeof(gxStat), 1, file);
+    fwrite(posResult, sizeof(posResult), 1, file);
+    fwrite(vecResult, sizeof(vecResult), 1, file);
+    fwrite(&gxFifoCount, sizeof(gxFifoCount), 1, file);
+}
+
+bool Gpu3D::validPolygon(_Polygon &polygon)
+{
+    // Check that a loaded polygon's values are ones the renderer can handle
+    // Texture sizes are unset until the first TEXIMAGE_PARAM, and otherwise range from 8 to 1024
+    for (int size: { polygon.sizeS, polygon.sizeT })
+        if (size != 0 && (size < 8 || size > 1024 || (size & (size - 1))))
+            return false;
+    return polygon.size >= 0 && polygon.size <= 10 && polygon.mode >= 0 && polygon.mode <= 3 &&
+        polygon.textureFmt >= 0 && polygon.textureFmt <= 7 && polygon.wShift > -32 && polygon.wShift < 32;
+}
+
+bool Gpu3D::loadState(FILE *file)
+{
+    // Read the FIFO entries from the file into staging, checking that they fit the queue
+    uint32_t count = 0;
+    if (fread(&count, sizeof(count), 1, file) != 1 || count > EntryQueue::capacity)
+        return false;
+    std::vector<Entry> entries(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (fread(&entries[i].command, sizeof(uint8_t), 1, file) != 1 ||
+            fread(&entries[i].param, sizeof(uint32_t), 1, file) != 1)
+            return false;
+    }
+
+    // Read the vertex and polygon buffers from the file into staging
+    // Counts are checked against the buffer sizes, and vertex indices against the vertex count
+    bool bufferIn = false;
+    if (fread(&bufferIn, sizeof(bufferIn), 1, file) != 1)
+        return false;
+    std::vector<Vertex> vertices[2];
+    std::vector<_Polygon> polygons[2];
+    for (int i = 0; i < 2; i++)
+    {
+        int vtxCount = 0, polyCount = 0;
+        if (fread(&vtxCount, sizeof(vtxCount), 1, file) != 1 || vtxCount < 0 || vtxCount > 6144)
+            return false;
+        vertices[i].resize(vtxCount);
+        if (fread(vertices[i].data(), sizeof(Vertex), vtxCount, file) != (size_t)vtxCount)
+            return false;
+        if (fread(&polyCount, sizeof(polyCount), 1, file) != 1 || polyCount < 0 || polyCount > 2048)
+            return false;
+        polygons[i].resize(polyCount);
+        for (int j = 0; j < polyCount; j++)
+        {
+            _Polygon &polygon = polygons[i][j];
+            if (fread(&polygon, sizeof(polygon), 1, file) != 1 || !validPolygon(polygon))
+                return false;
+            intptr_t index = (intptr_t)polygon.vertices;
+            if (index < 0 || index + polygon.size > vtxCount)
+                return false;
+        }
+    }
+
+    // Read the values that refer to the staged data, and check them against it
+    GXState newState;
+    size_t newPipeSize, newTestQueue, newMatrixQueue;
+    int newProcessCount, newVertexCount;
+    _Polygon newSavedPolygon;
+    if (fread(&newState, sizeof(newState), 1, file) != 1 ||
+        fread(&newPipeSize, sizeof(newPipeSize), 1, file) != 1 ||
+        fread(&newTestQueue, sizeof(newTestQueue), 1, file) != 1 ||
+        fread(&newMatrixQueue, sizeof(newMatrixQueue), 1, file) != 1 ||
+        fread(&newProcessCount, sizeof(newProcessCount), 1, file) != 1 ||
+        fread(&newVertexCount, sizeof(newVertexCount), 1, file) != 1 ||
+        fread(&newSavedPolygon, sizeof(newSavedPolygon), 1, file) != 1)
+        return false;
+    if (newState < GX_IDLE || newState > GX_HALTED || newPipeSize > 4 || newPipeSize > count ||
+        newTestQueue > count || newMatrixQueue > count || newProcessCount < 0 ||
+        newProcessCount > (int)vertices[0].size() || newVertexCount < 0 ||
+        newVertexCount > (int)vertices[0].size() || !validPolygon(newSavedPolygon))
+        return false;
+
+    // Finish any queued commands so they don't run on the loaded state
+    // Then drop any staged vertices, since saved states never have them
+    syncThread();
+    stagedCount = 0;
+
+    // Commit the staged data, converting vertex indices back to pointers
+    fifo.clear();
+    for (uint32_t i = 0; i < count; i++)
+        fifo.push(entries[i]);
+    verticesIn = bufferIn ? vertices2 : vertices1;
+    verticesOut = bufferIn ? vertices1 : vertices2;
+    polygonsIn = bufferIn ? polygons2 : polygons1;
+    polygonsOut = bufferIn ? polygons1 : polygons2;
+    for (int i = 0; i < 2; i++)
+    {
+        Vertex *vtxBuffer = i ? verticesOut : verticesIn;
+        _Polygon *polyBuffer = i ? polygonsOut : polygonsIn;
+        (i ? vertexCountOut : vertexCountIn) = vertices[i].size();
+        (i ? polygonCountOut : polygonCountIn) = polygons[i].size();
+        std::copy(vertices[i].begin(), vertices[i].end(), vtxBuffer);
+        for (size_t j = 0; j < polygons[i].size(); j++)
+        {
+            polyBuffer[j] = polygons[i][j];
+            polyBuffer[j].vertices = &vtxBuffer[(intptr_t)polygons[i][j].vertices];
+        }
+    }
+
+    // The saved polygon's vertex pointer is reassigned before use, so don't leave a stale one around
+    state = newState;
+    pipeSize = newPipeSize;
+    testQueue = newTestQueue;
+    matrixQueue = newMatrixQueue;
+    processCount = newProcessCount;
+    vertexCount = newVertexCount;
+    savedPolygon = newSavedPolygon;
+    savedPolygon.vertices = nullptr;
+
+    // Read the remaining state data from the file
+    // These are plain values, and the caller has already checked that the stream holds them
+    fread(&matrixMode, sizeof(matrixMode), 1, file);
+    stackMode = matrixMode;
+    fread(&clipDirty, sizeof(clipDirty), 1, file);
+    fread(&projection, sizeof(projection), 1, file);
+    fread(&projectionStack, sizeof(projectionStack), 1, file);
+    fread(&coordinate, sizeof(coordinate), 1, file);
+    fread(coordinateStack, sizeof(coordinateStack), 1, file);
+    fread(&direction, sizeof(direction), 1, file);
+    fread(directionStack, sizeof(directionStack), 1, file);
+    fread(&texture, sizeof(texture), 1, file);
+    fread(&textureStack, sizeof(textureStack), 1, file);
+    fread(&clip, sizeof(clip), 1, file);
+    fread(&savedVertex, sizeof(savedVertex), 1, file);
+    fread(&s, sizeof(s), 1, file);
+    fread(&t, sizeof(t), 1, file);
+    fread(&clockwise, sizeof(clockwise), 1, file);
+    fread(&polygonType, sizeof(polygonType), 1, file);
+    fread(&textureCoordMode, sizeof(textureCoordMode), 1, file);
+    fread(&polygonAttr, sizeof(polygonAttr), 1, file);
+    fread(&enabledLights, sizeof(enabledLights), 1, file);
+    fread(&renderBack, sizeof(renderBack), 1, file);
+    fread(&renderFront, sizeof(renderFront), 1, file);
+    fread(&diffuseColor, sizeof(diffuseColor), 1, file);
+    fread(&ambientColor, sizeof(ambientColor), 1, file);
+    fread(&specularColor, sizeof(specularColor), 1, file);
+    fread(&emissionColor, sizeof(emissionColor), 1, file);
+    fread(&shininessEnabled, sizeof(shininessEnabled), 1, file);
+    fread(lightVector, sizeof(lightVector), 1, file);
+    fread(halfVector, sizeof(halfVector), 1, file);
+    fread(lightColor, sizeof(lightColor), 1, file);
+    fread(shininess, sizeof(shininess), 1, file);
+    fread(viewport, sizeof(viewport), 1, file);
+    fread(viewportNext, sizeof(viewportNext), 1, file);
+    fread(&gxFifo, sizeof(gxFifo), 1, file);
+    fread(&gxStat, sizeof(gxStat), 1, file);
+    fread(posResult, sizeof(posResult), 1, file);
+    fread(vecResult, sizeof(vecResult), 1, file);
+    fread(&gxFifoCount, sizeof(gxFifoCount), 1, file);
+    return true;
+}
@@ -20,9 +20,12 @@
 #ifndef GPU_3D_H
 #define GPU_3D_H
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
-#include <queue>
-#include <vector>
+#include <cstdio>
+#include <mutex>
+#include <thread>
 
 #include "defines.h"
 
@@ -37,12 +40,34 @@ enum GXState
 
 struct Entry
 {
-    Entry(uint8_t command, uint32_t param): command(command), param(param) {}
+    Entry(uint8_t command = 0, uint32_t param = 0): command(command), param(param) {}
 
     uint8_t command;
     uint32_t param;
 };
 
+class EntryQueue
+{
+    public:
+        // Ring buffer for the FIFO and PIPE, with room for more than the 260 hardware entries
+        // Writes to a full FIFO halt the CPU but still go through, and a DMA can push a batch past the limit
+        static const size_t capacity = 0x400;
+
+        void push(Entry entry) { entries[(start + count++) & (capacity - 1)] = entry; }
+        void pop()             { start = (start + 1) & (capacity - 1); count--;       }
+        void clear()           { start = count = 0;                                   }
+
+        Entry &front()          { return entries[start];                            }
+        Entry &at(size_t index) { return entries[(start + index) & (capacity - 1)]; }
+        size_t size()           { return count;                                     }
+        bool   empty()          { return count == 0;                                }
+        bool   full()           { return count == capacity;                         }
+
+    private:
+        Entry entries[capacity];
+        size_t start = 0, count = 0;
+};
+
 struct Matrix
 {
     int32_t data[4 * 4] =
@@ -102,7 +127,11 @@ struct _Polygon
 class Gpu3D
 {
     public:
-        Gpu3D(Core *core): core(core) {}
+        Gpu3D(Core *core);
+        ~Gpu3D();
+
+        void saveState(FILE *file);
+        bool loadState(FILE *file);
 
         void runCommand();
         void swapBuffers();
@@ -120,6 +149,7 @@ class Gpu3D
         uint32_t readVecMtxResult(int index);
 
         void writeGxFifo(uint32_t mask, uint32_t value);
+        void writeGxFifo(uint32_t *values, int count);
         void writeMtxMode(uint32_t mask, uint32_t value);
         void writeMtxPush(uint32_t mask, uint32_t value);
         void writeMtxPop(uint32_t mask, uint32_t value);
@@ -164,14 +194,30 @@ class Gpu3D
 
         GXState state = GX_IDLE;
 
-        std::queue<Entry> fifo;
+        EntryQueue fifo;
         size_t pipeSize = 0;
         size_t testQueue = 0;
         size_t matrixQueue = 0;
 
         static const uint8_t paramCounts[0x100];
 
+        // Commands are queued here for the geometry thread, each as a word with the command and parameter count
+        // followed by the parameters; the read and write positions wrap around the buffer
+        static const uint32_t WORK_MASK = 0x3FFF;
+        uint32_t workQueue[WORK_MASK + 1];
+        std::atomic<uint32_t> workWrite, workRead;
+        std::atomic<bool> running;
+        std::thread *thread = nullptr;
+
+        // Either side sleeps if it has to wait for a while, flagging it so the other side knows to wake it
+        static const int WAIT_SPINS = 256;
+        std::mutex workMutex;
+        std::condition_variable workReady, workDone;
+        std::atomic<bool> threadWaiting, callerWaiting;
+
+        // The matrix mode is tracked separately for stack status, since that's updated before commands execute
         uint8_t matrixMode = 0;
+        uint8_t stackMode = 0;
         bool clipDirty = false;
 
         Matrix projection, projectionStack;
@@ -189,6 +235,13 @@ class Gpu3D
         _Polygon *polygonsIn = polygons1, *polygonsOut = polygons2;
         int polygonCountIn = 0, polygonCountOut = 0;
 
+        // Vertices waiting to be transformed and assembled into polygons, kept as separate arrays for batching
+        // Each coordinate array has room past the end so the batch can be rounded up
+        int32_t stagedX[260] = {}, stagedY[260] = {}, stagedZ[260] = {};
+        int16_t stagedS[256] = {}, stagedT[256] = {};
+        uint32_t stagedColor[256] = {};
+        int stagedCount = 0;
+
         Vertex savedVertex;
         _Polygon savedPolygon;
         int16_t s, t;
@@ -222,28 +275,31 @@ class Gpu3D
         static uint32_t rgb5ToRgb6(uint16_t color);
         static Vertex intersection(Vertex *vtx1, Vertex *vtx2, int32_t val1, int32_t val2);
         static bool clipPolygon(Vertex *unclipped, Vertex *clipped, int *size);
+        static bool validPolygon(_Polygon &polygon);
 
         void processVertices();
-        void addVertex();
+        void stageVertex();
+        void flushVertices();
+        void addVertex(Vertex &vertex);
         void addPolygon();
 
         void mtxModeCmd(uint32_t param);
-        void mtxPushCmd();
+        void mtxPushCmd(uint32_t param);
         void mtxPopCmd(uint32_t param);
         void mtxStoreCmd(uint32_t param);
         void mtxRestoreCmd(uint32_t param);
         void mtxIdentityCmd();
-        void mtxLoad44Cmd(std::vector<uint32_t> &params);
-        void mtxLoad43Cmd(std::vector<uint32_t> &params);
-        void mtxMult44Cmd(std::vector<uint32_t> &params);
-        void mtxMult43Cmd(std::vector<uint32_t> &params);
-        void mtxMult33Cmd(std::vector<uint32_t> &params);
-        void mtxScaleCmd(std::vector<uint32_t> &params);
-        void mtxTransCmd(std::vector<uint32_t> &params);
+        void mtxLoad44Cmd(uint32_t *params);
+        void mtxLoad43Cmd(uint32_t *params);
+        void mtxMult44Cmd(uint32_t *params);
+        void mtxMult43Cmd(uint32_t *params);
+        void mtxMult33Cmd(uint32_t *params);
+        void mtxScaleCmd(uint32_t *params);
+        void mtxTransCmd(uint32_t *params);
         void colorCmd(uint32_t param);
         void normalCmd(uint32_t param);
         void texCoordCmd(uint32_t param);
-        void vtx16Cmd(std::vector<uint32_t> &params);
+        void vtx16Cmd(uint32_t *params);
         void vtx10Cmd(uint32_t param);
         void vtxXYCmd(uint32_t param);
         void vtxXZCmd(uint32_t param);
@@ -256,15 +312,28 @@ class Gpu3D
         void speEmiCmd(uint32_t param);
         void lightVectorCmd(uint32_t param);
         void lightColorCmd(uint32_t param);
-        void shininessCmd(std::vector<uint32_t> &params);
+        void shininessCmd(uint32_t *params);
         void beginVtxsCmd(uint32_t param);
         void swapBuffersCmd(uint32_t param);
         void viewportCmd(uint32_t param);
-        void boxTestCmd(std::vector<uint32_t> &params);
-        void posTestCmd(std::vector<uint32_t> &params);
+        void boxTestCmd(uint32_t *params);
+        void posTestCmd(uint32_t *params);
         void vecTestCmd(uint32_t param);
 
+        uint32_t updateStack(uint8_t command, uint32_t param);
+        void executeCommand(uint8_t command, uint32_t *params);
+
+        void queueCommand(uint8_t command, uint32_t *params, int count);
+        void runThreaded();
+        void startThread();
+        void stopThread();
+        void syncThread();
+        void waitThread(uint32_t words);
+
         void addEntry(Entry entry);
+        void queueEntry(Entry entry);
+        void updateFifo();
+        void unpackGxFifo(uint32_t value);
 };
 
 #endif // GPU_3D_H
@@ -17,31 +17,621 @@
     along with NooDS. If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
 #include <cstring>
-#include <vector>
 
 #include "gpu_3d_renderer.h"
 #include "core.h"
 #include "settings.h"
 
+// Use vector instructions for span interpolation where they're available
+// On x86 they're picked at runtime, so builds still work on CPUs without them
+// Divisions are done with doubles, which NEON only supports on 64-bit ARM
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SIMD_X86
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define SIMD_NEON
+#endif
+
+// Values needed to interpolate across a polygon span on the current line
+// Texture coordinates are stored offset to be unsigned, the same as during interpolation
+struct SpanSetup
+{
+    uint32_t x1, x4;
+    uint32_t we[2], ze[2];
+    uint32_t re[2], ge[2], be[2];
+    uint32_t se[2], te[2];
+    uint32_t scaleBits;
+    bool linear;
+    bool wBuffer;
+    int wShift;
+    bool textured;
+};
+
+// Interpolated values for a batch of up to 8 pixels in a span
+// Colors are RGB6 without alpha, and texture coordinates have their fractional bits removed
+// Factors are kept from the depth values so the rest can be interpolated only if a pixel passes the depth test
+struct SpanValues
+{
+    uint32_t factor[8];
+    int32_t depth[8];
+    uint32_t color[8];
+    int32_t s[8], t[8];
+};
+
+// Interpolates 8 pixels of a span starting at an X coordinate, exactly matching the scalar code
+// Pixels past the end of the span are calculated as well, but their values are meaningless
+// Depth values and factors are done first, then colors and texture coordinates using the factors
+typedef void (*SpanFunc)(const SpanSetup &setup, uint32_t x, SpanValues &out);
+
+#ifdef SIMD_X86
+
+__attribute__((target("sse4.1"), always_inline)) static inline __m128d toDoubleSse41(__m128i value)
+{
+    // Convert the low 2 unsigned words to doubles, offsetting them since the conversion is signed
+    __m128i offset = _mm_xor_si128(value, _mm_set1_epi32(0x80000000));
+    return _mm_add_pd(_mm_cvtepi32_pd(offset), _mm_set1_pd(2147483648.0));
+}
+
+__attribute__((target("sse4.1"), always_inline)) static inline __m128i fromDoubleSse41(__m128d low, __m128d high)
+{
+    // Convert 2 pairs of whole doubles to unsigned words, offsetting them since the conversion is signed
+    __m128i lowWords = _mm_cvttpd_epi32(_mm_sub_pd(low, _mm_set1_pd(2147483648.0)));
+    __m128i highWords = _mm_cvttpd_epi32(_mm_sub_pd(high, _mm_set1_pd(2147483648.0)));
+    return _mm_xor_si128(_mm_unpacklo_epi64(lowWords, highWords), _mm_set1_epi32(0x80000000));
+}
+
+__attribute__((target("sse4.1"), always_inline)) static inline __m128i divideSse41(__m128i a, __m128i b)
+{
+    // Divide unsigned words as doubles; the truncated quotient of 32-bit values is always exact
+    __m128d low = _mm_div_pd(toDoubleSse41(a), toDoubleSse41(b));
+    __m128d high = _mm_div_pd(toDoubleSse41(_mm_srli_si128(a, 8)), toDoubleSse41(_mm_srli_si128(b, 8)));
+    return fromDoubleSse41(_mm_round_pd(low, _MM_FROUND_TO_ZERO), _mm_round_pd(high, _MM_FROUND_TO_ZERO));
+}
+
+__attribute__((target("sse4.1"), always_inline)) static inline __m128d divideRangeSse41(__m128d a, __m128d range, __m128d inverse)
+{
+    // Divide by a constant using its reciprocal, which can be off by one, so correct it using the remainder
+    __m128d quot = _mm_round_pd(_mm_mul_pd(a, inverse), _MM_FROUND_TO_ZERO);
+    __m128d rem = _mm_sub_pd(a, _mm_mul_pd(quot, range));
+    quot = _mm_sub_pd(quot, _mm_and_pd(_mm_cmplt_pd(rem, _mm_setzero_pd()), _mm_set1_pd(1.0)));
+    return _mm_add_pd(quot, _mm_and_pd(_mm_cmpge_pd(rem, range), _mm_set1_pd(1.0)));
+}
+
+__attribute__((target("sse4.1"), always_inline)) static inline __m128i divideRangeSse41(__m128i a, __m128d range, __m128d inverse)
+{
+    // Divide unsigned words by a constant, 2 at a time
+    __m128d low = divideRangeSse41(toDoubleSse41(a), range, inverse);
+    __m128d high = divideRangeSse41(toDoubleSse41(_mm_srli_si128(a, 8)), range, inverse);
+    return fromDoubleSse41(low, high);
+}
+
+__attribute__((target("sse4.1"), always_inline)) static inline __m128i lessEqualSse41(__m128i a, __m128i b)
+{
+    // Compare unsigned words, since SSE only has signed comparisons
+    return _mm_cmpeq_epi32(_mm_min_epu32(a, b), a);
+}
+
+__attribute__((target("sse4.1"), always_inline)) static inline __m128i interpolateSse41(const SpanSetup &setup,
+    bool linear, __m128i x, __m128i factor, __m128d range, __m128d inverse, uint32_t v1, uint32_t v2)
+{
+    if (linear)
+    {
+        // Linearly interpolate a new value between the min and max values
+        __m128i result;
+        if (v1 <= v2)
+        {
+            __m128i dist = _mm_sub_epi32(x, _mm_set1_epi32(setup.x1));
+            __m128i quot = divideRangeSse41(_mm_mullo_epi32(_mm_set1_epi32(v2 - v1), dist), range, inverse);
+            result = _mm_add_epi32(_mm_set1_epi32(v1), quot);
+        }
+        else
+        {
+            __m128i dist = _mm_sub_epi32(_mm_set1_epi32(setup.x4), x);
+            __m128i quot = divideRangeSse41(_mm_mullo_epi32(_mm_set1_epi32(v1 - v2), dist), range, inverse);
+            result = _mm_add_epi32(_mm_set1_epi32(v2), quot);
+        }
+
+        // Clamp to the min and max values outside of the bounds
+        result = _mm_blendv_epi8(result, _mm_set1_epi32(v2), lessEqualSse41(_mm_set1_epi32(setup.x4), x));
+        return _mm_blendv_epi8(result, _mm_set1_epi32(v1), lessEqualSse41(x, _mm_set1_epi32(setup.x1)));
+    }
+
+    // Interpolate a new value between the min and max values using a factor
+    if (v1 <= v2)
+        return _mm_add_epi32(_mm_set1_epi32(v1), _mm_srli_epi32(_mm_mullo_epi32(_mm_set1_epi32(v2 - v1), factor), 8));
+    factor = _mm_sub_epi32(_mm_set1_epi32(1 << 8), factor);
+    return _mm_add_epi32(_mm_set1_epi32(v2), _mm_srli_epi32(_mm_mullo_epi32(_mm_set1_epi32(v1 - v2), factor), 8));
+}
+
+__attribute__((target("sse4.1"))) static void spanDepthSse41(const SpanSetup &setup, uint32_t x, SpanValues &out)
+{
+    // Divide by the span width using its reciprocal, since it's the same for every pixel
+    __m128d range = _mm_set1_pd(setup.x4 - setup.x1);
+    __m128d inverse = _mm_set1_pd(1.0 / (setup.x4 - setup.x1));
+
+    // Interpolate 4 pixels at a time
+    for (int i = 0; i < 8; i += 4)
+    {
+        __m128i xs = _mm_add_epi32(_mm_set1_epi32(x + i), _mm_setr_epi32(0, 1, 2, 3));
+        __m128i factor = _mm_setzero_si128();
+
+        // Calculate the interpolation factor with a precision of 8 bits for polygon fills
+        if (!setup.linear)
+        {
+            // Adjust interpolation precision to avoid overflow at higher resolutions
+            // The shifts are done as multiplies, since each pixel can shift by a different amount
+            __m128i dist = _mm_sub_epi32(xs, _mm_set1_epi32(setup.x1));
+            __m128i pre = _mm_set1_epi32(1 << 8), post = _mm_set1_epi32(1);
+            for (uint32_t s = 0; s < setup.scaleBits; s++)
+            {
+                __m128i mask = lessEqualSse41(_mm_set1_epi32(0x100 << s), dist);
+                pre = _mm_sub_epi32(pre, _mm_and_si128(mask, _mm_set1_epi32(0x80 >> s)));
+                post = _mm_add_epi32(post, _mm_and_si128(mask, _mm_set1_epi32(1 << s)));
+            }
+
+            __m128i left = _mm_mullo_epi32(_mm_set1_epi32(setup.we[0]), dist);
+            __m128i right = _mm_mullo_epi32(_mm_set1_epi32(setup.we[1]), _mm_sub_epi32(_mm_set1_epi32(setup.x4), xs));
+            factor = _mm_mullo_epi32(divideSse41(_mm_mullo_epi32(left, pre), _mm_add_epi32(right, left)), post);
+
+            // Clamp to the min and max values outside of the bounds
+            factor = _mm_blendv_epi8(factor, _mm_set1_epi32(1 << 8), lessEqualSse41(_mm_set1_epi32(setup.x4), xs));
+            factor = _mm_blendv_epi8(factor, _mm_setzero_si128(), lessEqualSse41(xs, _mm_set1_epi32(setup.x1)));
+        }
+        _mm_storeu_si128((__m128i*)&out.factor[i], factor);
+
+        // Calculate the depth values
+        __m128i depth;
+        if (setup.wBuffer)
+        {
+            depth = interpolateSse41(setup, setup.linear, xs, factor, range, inverse, setup.we[0], setup.we[1]);
+            if (setup.wShift > 0)
+                depth = _mm_sll_epi32(depth, _mm_cvtsi32_si128(setup.wShift));
+            else if (setup.wShift < 0)
+                depth = _mm_sra_epi32(depth, _mm_cvtsi32_si128(-setup.wShift));
+        }
+        else
+        {
+            depth = interpolateSse41(setup, true, xs, factor, range, inverse, setup.ze[0], setup.ze[1]);
+        }
+        _mm_storeu_si128((__m128i*)&out.depth[i], depth);
+    }
+}
+
+__attribute__((target("sse4.1"))) static void spanColorSse41(const SpanSetup &setup, uint32_t x, SpanValues &out)
+{
+    // Divide by the span width using its reciprocal, since it's the same for every pixel
+    __m128d range = _mm_set1_pd(setup.x4 - setup.x1);
+    __m128d inverse = _mm_set1_pd(1.0 / (setup.x4 - setup.x1));
+
+    // Interpolate 4 pixels at a time, reusing the factors from the depth values
+    for (int i = 0; i < 8; i += 4)
+    {
+        __m128i xs = _mm_add_epi32(_mm_set1_epi32(x + i), _mm_setr_epi32(0, 1, 2, 3));
+        __m128i factor = _mm_loadu_si128((__m128i*)&out.factor[i]);
+
+        // Calculate the vertex colors
+        __m128i r = _mm_srli_epi32(interpolateSse41(setup, setup.linear, xs, factor, range, inverse, setup.re[0], setup.re[1]), 3);
+        __m128i g = _mm_srli_epi32(interpolateSse41(setup, setup.linear, xs, factor, range, inverse, setup.ge[0], setup.ge[1]), 3);
+        __m128i b = _mm_srli_epi32(interpolateSse41(setup, setup.linear, xs, factor, range, inverse, setup.be[0], setup.be[1]), 3);
+        __m128i color = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(b, 12), _mm_slli_epi32(g, 6)), r);
+        _mm_storeu_si128((__m128i*)&out.color[i], color);
+
+        // Calculate the texture coordinates, converting them back to signed
+        if (setup.textured)
+        {
+            __m128i s = interpolateSse41(setup, setup.linear, xs, factor, range, inverse, setup.se[0], setup.se[1]);
+            __m128i t = interpolateSse41(setup, setup.linear, xs, factor, range, inverse, setup.te[0], setup.te[1]);
+            _mm_storeu_si128((__m128i*)&out.s[i], _mm_srai_epi32(_mm_sub_epi32(s, _mm_set1_epi32(0xFFFF)), 4));
+            _mm_storeu_si128((__m128i*)&out.t[i], _mm_srai_epi32(_mm_sub_epi32(t, _mm_set1_epi32(0xFFFF)), 4));
+        }
+    }
+}
+
+__attribute__((target("avx2"), always_inline)) static inline __m256d toDoubleAvx2(__m128i value)
+{
+    // Convert 4 unsigned words to doubles, offsetting them since the conversion is signed
+    __m128i offset = _mm_xor_si128(value, _mm_set1_epi32(0x80000000));
+    return _mm256_add_pd(_mm256_cvtepi32_pd(offset), _mm256_set1_pd(2147483648.0));
+}
+
+__attribute__((target("avx2"), always_inline)) static inline __m256i fromDoubleAvx2(__m256d low, __m256d high)
+{
+    // Convert 2 sets of 4 whole doubles to unsigned words, offsetting them since the conversion is signed
+    __m128i lowWords = _mm256_cvttpd_epi32(_mm256_sub_pd(low, _mm256_set1_pd(2147483648.0)));
+    __m128i highWords = _mm256_cvttpd_epi32(_mm256_sub_pd(high, _mm256_set1_pd(2147483648.0)));
+    __m256i words = _mm256_inserti128_si256(_mm256_castsi128_si256(lowWords), highWords, 1);
+    return _mm256_xor_si256(words, _mm256_set1_epi32(0x80000000));
+}
+
+__attribute__((target("avx2"), always_inline)) static inline __m256i divideAvx2(__m256i a, __m256i b)
+{
+    // Divide unsigned words as doubles; the truncated quotient of 32-bit values is always exact
+    __m256d low = _mm256_div_pd(toDoubleAvx2(_mm256_castsi256_si128(a)), toDoubleAvx2(_mm256_castsi256_si128(b)));
+    __m256d high = _mm256_div_pd(toDoubleAvx2(_mm256_extracti128_si256(a, 1)), toDoubleAvx2(_mm256_extracti128_si256(b, 1)));
+    return fromDoubleAvx2(_mm256_round_pd(low, _MM_FROUND_TO_ZERO), _mm256_round_pd(high, _MM_FROUND_TO_ZERO));
+}
+
+__attribute__((target("avx2"), always_inline)) static inline __m256d divideRangeAvx2(__m256d a, __m256d range, __m256d inverse)
+{
+    // Divide by a constant using its reciprocal, which can be off by one, so correct it using the remainder
+    __m256d quot = _mm256_round_pd(_mm256_mul_pd(a, inverse), _MM_FROUND_TO_ZERO);
+    __m256d rem = _mm256_sub_pd(a, _mm256_mul_pd(quot, range));
+    quot = _mm256_sub_pd(quot, _mm256_and_pd(_mm256_cmp_pd(rem, _mm256_setzero_pd(), _CMP_LT_OQ), _mm256_set1_pd(1.0)));
+    return _mm256_add_pd(quot, _mm256_and_pd(_mm256_cmp_pd(rem, range, _CMP_GE_OQ), _mm256_set1_pd(1.0)));
+}
+
+__attribute__((target("avx2"), always_inline)) static inline __m256i divideRangeAvx2(__m256i a, __m256d range, __m256d inverse)
+{
+    // Divide unsigned words by a constant, 4 at a time
+    __m256d low = divideRangeAvx2(toDoubleAvx2(_mm256_castsi256_si128(a)), range, inverse);
+    __m256d high = divideRangeAvx2(toDoubleAvx2(_mm256_extracti128_si256(a, 1)), range, inverse);
+    return fromDoubleAvx2(low, high);
+}
+
+__attribute__((target("avx2"), always_inline)) static inline __m256i lessEqualAvx2(__m256i a, __m256i b)
+{
+    // Compare unsigned words, since AVX2 only has signed comparisons
+    return _mm256_cmpeq_epi32(_mm256_min_epu32(a, b), a);
+}
+
+__attribute__((target("avx2"), always_inline)) static inline __m256i interpolateAvx2(const SpanSetup &setup,
+    bool linear, __m256i x, __m256i factor, __m256d range, __m256d inverse, uint32_t v1, uint32_t v2)
+{
+    if (linear)
+    {
+        // Linearly interpolate a new value between the min and max values
+        __m256i result;
+        if (v1 <= v2)
+        {
+            __m256i dist = _mm256_sub_epi32(x, _mm256_set1_epi32(setup.x1));
+            __m256i quot = divideRangeAvx2(_mm256_mullo_epi32(_mm256_set1_epi32(v2 - v1), dist), range, inverse);
+            result = _mm256_add_epi32(_mm256_set1_epi32(v1), quot);
+        }
+        else
+        {
+            __m256i dist = _mm256_sub_epi32(_mm256_set1_epi32(setup.x4), x);
+            __m256i quot = divideRangeAvx2(_mm256_mullo_epi32(_mm256_set1_epi32(v1 - v2), dist), range, inverse);
+            result = _mm256_add_epi32(_mm256_set1_epi32(v2), quot);
+        }
+
+        // Clamp to the min and max values outside of the bounds
+        result = _mm256_blendv_epi8(result, _mm256_set1_epi32(v2), lessEqualAvx2(_mm256_set1_epi32(setup.x4), x));
+        return _mm256_blendv_epi8(result, _mm256_set1_epi32(v1), lessEqualAvx2(x, _mm256_set1_epi32(setup.x1)));
+    }
+
+    // Interpolate a new value between the min and max values using a factor
+    if (v1 <= v2)
+        return _mm256_add_epi32(_mm256_set1_epi32(v1), _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(v2 - v1), factor), 8));
+    factor = _mm256_sub_epi32(_mm256_set1_epi32(1 << 8), factor);
+    return _mm256_add_epi32(_mm256_set1_epi32(v2), _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32(v1 - v2), factor), 8));
+}
+
+__attribute__((target("avx2"))) static void spanDepthAvx2(const SpanSetup &setup, uint32_t x, SpanValues &out)
+{
+    // Divide by the span width using its reciprocal, since it's the same for every pixel
+    __m256d range = _mm256_set1_pd(setup.x4 - setup.x1);
+    __m256d inverse = _mm256_set1_pd(1.0 / (setup.x4 - setup.x1));
+
+    __m256i xs = _mm256_add_epi32(_mm256_set1_epi32(x), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    __m256i factor = _mm256_setzero_si256();
+
+    // Calculate the interpolation factor with a precision of 8 bits for polygon fills
+    if (!setup.linear)
+    {
+        // Adjust interpolation precision to avoid overflow at higher resolutions
+        // The shifts are done as multiplies, since each pixel can shift by a different amount
+        __m256i dist = _mm256_sub_epi32(xs, _mm256_set1_epi32(setup.x1));
+        __m256i pre = _mm256_set1_epi32(1 << 8), post = _mm256_set1_epi32(1);
+        for (uint32_t s = 0; s < setup.scaleBits; s++)
+        {
+            __m256i mask = lessEqualAvx2(_mm256_set1_epi32(0x100 << s), dist);
+            pre = _mm256_sub_epi32(pre, _mm256_and_si256(mask, _mm256_set1_epi32(0x80 >> s)));
+            post = _mm256_add_epi32(post, _mm256_and_si256(mask, _mm256_set1_epi32(1 << s)));
+        }
+
+        __m256i left = _mm256_mullo_epi32(_mm256_set1_epi32(setup.we[0]), dist);
+        __m256i right = _mm256_mullo_epi32(_mm256_set1_epi32(setup.we[1]), _mm256_sub_epi32(_mm256_set1_epi32(setup.x4), xs));
+        factor = _mm256_mullo_epi32(divideAvx2(_mm256_mullo_epi32(left, pre), _mm256_add_epi32(right, left)), post);
+
+        // Clamp to the min and max values outside of the bounds
+        factor = _mm256_blendv_epi8(factor, _mm256_set1_epi32(1 << 8), lessEqualAvx2(_mm256_set1_epi32(setup.x4), xs));
+        factor = _mm256_blendv_epi8(factor, _mm256_setzero_si256(), lessEqualAvx2(xs, _mm256_set1_epi32(setup.x1)));
+    }
+    _mm256_storeu_si256((__m256i*)out.factor, factor);
+
+    // Calculate the depth values
+    __m256i depth;
+    if (setup.wBuffer)
+    {
+        depth = interpolateAvx2(setup, setup.linear, xs, factor, range, inverse, setup.we[0], setup.we[1]);
+        if (setup.wShift > 0)
+            depth = _mm256_sll_epi32(depth, _mm_cvtsi32_si128(setup.wShift));
+        else if (setup.wShift < 0)
+            depth = _mm256_sra_epi32(depth, _mm_cvtsi32_si128(-setup.wShift));
+    }
+    else
+    {
+        depth = interpolateAvx2(setup, true, xs, factor, range, inverse, setup.ze[0], setup.ze[1]);
+    }
+    _mm256_storeu_si256((__m256i*)out.depth, depth);
+}
+
+__attribute__((target("avx2"))) static void spanColorAvx2(const SpanSetup &setup, uint32_t x, SpanValues &out)
+{
+    // Divide by the span width using its reciprocal, since it's the same for every pixel
+    __m256d range = _mm256_set1_pd(setup.x4 - setup.x1);
+    __m256d inverse = _mm256_set1_pd(1.0 / (setup.x4 - setup.x1));
+
+    // Reuse the factors from the depth values
+    __m256i xs = _mm256_add_epi32(_mm256_set1_epi32(x), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    __m256i factor = _mm256_loadu_si256((__m256i*)out.factor);
+
+    // Calculate the vertex colors
+    __m256i r = _mm256_srli_epi32(interpolateAvx2(setup, setup.linear, xs, factor, range, inverse, setup.re[0], setup.re[1]), 3);
+    __m256i g = _mm256_srli_epi32(interpolateAvx2(setup, setup.linear, xs, factor, range, inverse, setup.ge[0], setup.ge[1]), 3);
+    __m256i b = _mm256_srli_epi32(interpolateAvx2(setup, setup.linear, xs, factor, range, inverse, setup.be[0], setup.be[1]), 3);
+    __m256i color = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(b, 12), _mm256_slli_epi32(g, 6)), r);
+    _mm256_storeu_si256((__m256i*)out.color, color);
+
+    // Calculate the texture coordinates, converting them back to signed
+    if (setup.textured)
+    {
+        __m256i s = interpolateAvx2(setup, setup.linear, xs, factor, range, inverse, setup.se[0], setup.se[1]);
+        __m256i t = interpolateAvx2(setup, setup.linear, xs, factor, range, inverse, setup.te[0], setup.te[1]);
+        _mm256_storeu_si256((__m256i*)out.s, _mm256_srai_epi32(_mm256_sub_epi32(s, _mm256_set1_epi32(0xFFFF)), 4));
+        _mm256_storeu_si256((__m256i*)out.t, _mm256_srai_epi32(_mm256_sub_epi32(t, _mm256_set1_epi32(0xFFFF)), 4));
+    }
+}
+
+#elif defined(SIMD_NEON)
+
+__attribute__((always_inline)) static inline uint32x4_t divideNeon(uint32x4_t a, uint32x4_t b)
+{
+    // Divide unsigned words as doubles; the truncated quotient of 32-bit values is always exact
+    float64x2_t low = vdivq_f64(vcvtq_f64_u64(vmovl_u32(vget_low_u32(a))), vcvtq_f64_u64(vmovl_u32(vget_low_u32(b))));
+    float64x2_t high = vdivq_f64(vcvtq_f64_u64(vmovl_u32(vget_high_u32(a))), vcvtq_f64_u64(vmovl_u32(vget_high_u32(b))));
+    return vcombine_u32(vmovn_u64(vcvtq_u64_f64(low)), vmovn_u64(vcvtq_u64_f64(high)));
+}
+
+__attribute__((always_inline)) static inline uint32x4_t interpolateNeon(const SpanSetup &setup, bool linear, uint32x4_t x,
+    uint32x4_t factor, uint32_t v1, uint32_t v2)
+{
+    if (linear)
+    {
+        // Linearly interpolate a new value between the min and max values
+        uint32x4_t result, range = vdupq_n_u32(setup.x4 - setup.x1);
+        if (v1 <= v2)
+            result = vaddq_u32(vdupq_n_u32(v1), divideNeon(vmulq_n_u32(vsubq_u32(x, vdupq_n_u32(setup.x1)), v2 - v1), range));
+        else
+            result = vaddq_u32(vdupq_n_u32(v2), divideNeon(vmulq_n_u32(vsubq_u32(vdupq_n_u32(setup.x4), x), v1 - v2), range));
+
+        // Clamp to the min and max values outside of the bounds
+        result = vbslq_u32(vcgeq_u32(x, vdupq_n_u32(setup.x4)), vdupq_n_u32(v2), result);
+        return vbslq_u32(vcleq_u32(x, vdupq_n_u32(setup.x1)), vdupq_n_u32(v1), result);
+    }
+
+    // Interpolate a new value between the min and max values using a factor
+    if (v1 <= v2)
+        return vaddq_u32(vdupq_n_u32(v1), vshrq_n_u32(vmulq_n_u32(factor, v2 - v1), 8));
+    factor = vsubq_u32(vdupq_n_u32(1 << 8), factor);
+    return vaddq_u32(vdupq_n_u32(v2), vshrq_n_u32(vmulq_n_u32(factor, v1 - v2), 8));
+}
+
+static void spanDepthNeon(const SpanSetup &setup, uint32_t x, SpanValues &out)
+{
+    // Interpolate 4 pixels at a time
+    static const uint32_t offsets[] = { 0, 1, 2, 3 };
+    for (int i = 0; i < 8; i += 4)
+    {
+        uint32x4_t xs = vaddq_u32(vdupq_n_u32(x + i), vld1q_u32(offsets));
+        uint32x4_t factor = vdupq_n_u32(0);
+
+        // Calculate the interpolation factor with a precision of 8 bits for polygon fills
+        if (!setup.linear)
+        {
+            // Adjust interpolation precision to avoid overflow at higher resolutions
+            // The shifts are done as multiplies, since each pixel can shift by a different amount
+            uint32x4_t dist = vsubq_u32(xs, vdupq_n_u32(setup.x1));
+            uint32x4_t pre = vdupq_n_u32(1 << 8), post = vdupq_n_u32(1);
+            for (uint32_t s = 0; s < setup.scaleBits; s++)
+            {
+                uint32x4_t mask = vcgeq_u32(dist, vdupq_n_u32(0x100 << s));
+                pre = vsubq_u32(pre, vandq_u32(mask, vdupq_n_u32(0x80 >> s)));
+                post = vaddq_u32(post, vandq_u32(mask, vdupq_n_u32(1 << s)));
+            }
+
+            uint32x4_t left = vmulq_n_u32(dist, setup.we[0]);
+            uint32x4_t right = vmulq_n_u32(vsubq_u32(vdupq_n_u32(setup.x4), xs), setup.we[1]);
+            factor = vmulq_u32(divideNeon(vmulq_u32(left, pre), vaddq_u32(right, left)), post);
+
+            // Clamp to the min and max values outside of the bounds
+            factor = vbslq_u32(vcgeq_u32(xs, vdupq_n_u32(setup.x4)), vdupq_n_u32(1 << 8), factor);
+            factor = vbslq_u32(vcleq_u32(xs, vdupq_n_u32(setup.x1)), vdupq_n_u32(0), factor);
+        }
+        vst1q_u32(&out.factor[i], factor);
+
+        // Calculate the depth values, using a negative shift to shift right
+        int32x4_t depth;
+        if (setup.wBuffer)
+        {
+            depth = vreinterpretq_s32_u32(interpolateNeon(setup, setup.linear, xs, factor, setup.we[0], setup.we[1]));
+            depth = vshlq_s32(depth, vdupq_n_s32(setup.wShift));
+        }
+        else
+        {
+            depth = vreinterpretq_s32_u32(interpolateNeon(setup, true, xs, factor, setup.ze[0], setup.ze[1]));
+        }
+        vst1q_s32(&out.depth[i], depth);
+    }
+}
+
+static void spanColorNeon(const SpanSetup &setup, uint32_t x, SpanValues &out)
+{
+    // Interpolate 4 pixels at a time, reusing the factors from the depth values
+    static const uint32_t offsets[] = { 0, 1, 2, 3 };
+    for (int i = 0; i < 8; i += 4)
+    {
+        uint32x4_t xs = vaddq_u32(vdupq_n_u32(x + i), vld1q_u32(offsets));
+        uint32x4_t factor = vld1q_u32(&out.factor[i]);
+
+        // Calculate the vertex colors
+        uint32x4_t r = vshrq_n_u32(interpolateNeon(setup, setup.linear, xs, factor, setup.re[0], setup.re[1]), 3);
+        uint32x4_t g = vshrq_n_u32(interpolateNeon(setup, setup.linear, xs, factor, setup.ge[0], setup.ge[1]), 3);
+        uint32x4_t b = vshrq_n_u32(interpolateNeon(setup, setup.linear, xs, factor, setup.be[0], setup.be[1]), 3);
+        vst1q_u32(&out.color[i], vorrq_u32(vorrq_u32(vshlq_n_u32(b, 12), vshlq_n_u32(g, 6)), r));
+
+        // Calculate the texture coordinates, converting them back to signed
+        if (setup.textured)
+        {
+            uint32x4_t s = interpolateNeon(setup, setup.linear, xs, factor, setup.se[0], setup.se[1]);
+            uint32x4_t t = interpolateNeon(setup, setup.linear, xs, factor, setup.te[0], setup.te[1]);
+            vst1q_s32(&out.s[i], vshrq_n_s32(vreinterpretq_s32_u32(vsubq_u32(s, vdupq_n_u32(0xFFFF))), 4));
+            vst1q_s32(&out.t[i], vshrq_n_s32(vreinterpretq_s32_u32(vsubq_u32(t, vdupq_n_u32(0xFFFF))), 4));
+        }
+    }
+}
+
+#endif
+
+static int selectSimd()
+{
+#ifdef SIMD_X86
+    // Use the widest vector instructions the CPU supports
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return 2;
+    if (__builtin_cpu_supports("sse4.1"))
+        return 1;
+#elif defined(SIMD_NEON)
+    // NEON is always there when the compiler targets it
+    return 1;
+#endif
+    return 0;
+}
+
+static SpanFunc selectSpanDepth(int level)
+{
+    // Pick the depth kernel for a level of vector support, or none to use the scalar code
+#ifdef SIMD_X86
+    if (level == 2) return spanDepthAvx2;
+    if (level == 1) return spanDepthSse41;
+#elif defined(SIMD_NEON)
+    if (level == 1) return spanDepthNeon;
+#endif
+    return nullptr;
+}
+
+static SpanFunc selectSpanColor(int level)
+{
+    // Pick the color kernel for a level of vector support, or none to use the scalar code
+#ifdef SIMD_X86
+    if (level == 2) return spanColorAvx2;
+    if (level == 1) return spanColorSse41;
+#elif defined(SIMD_NEON)
+    if (level == 1) return spanColorNeon;
+#endif
+    return nullptr;
+}
+
+static const int simdLevel = selectSimd();
+static const SpanFunc spanDepth = selectSpanDepth(simdLevel);
+static const SpanFunc spanColor = selectSpanColor(simdLevel);
+
 Gpu3DRenderer::Gpu3DRenderer(Core *core): core(core)
 {
+    // Allocate the buffers at native resolution to start
+    setScale(1);
+
     // Mark the scanlines as ready to start
     // This is mainly in case 3D is requested before the threads have a chance to start
-    for (int i = 0; i < 192 * 2; i++)
+    for (int i = 0; i < 192 * MAX_SCALE; i++)
         ready[i].store(3);
+
+    // Mark the tiles as having no jobs to start
+    nextTileJob.store(0);
+    for (int i = 0; i < 192 * MAX_SCALE / TILE_HEIGHT; i++)
+        tilesDrawn[i].store(0);
+    progressWaiters.store(0);
 }
 
 Gpu3DRenderer::~Gpu3DRenderer()
 {
+    // Wait for the threads to finish drawing, and then tell them to exit
+    joinThreads();
+    {
+        std::lock_guard<std::mutex> guard(poolMutex);
+        poolExit = true;
+    }
+    poolStart.notify_all();
+
     // Clean up the threads
-    for (int i = 0; i < activeThreads; i++)
+    for (size_t i = 0; i < threads.size(); i++)
+    {
+        threads[i]->join();
+        delete threads[i];
+    }
+}
+
+void Gpu3DRenderer::joinThreads()
+{
+    // Wait for any threads to finish drawing the current frame
+    std::unique_lock<std::mutex> lock(poolMutex);
+    poolFinish.wait(lock, [this] { return poolBusy == 0; });
+}
+
+template <typename F> void Gpu3DRenderer::waitProgress(F done)
+{
+    // Spin briefly in case the other threads are almost there
+    for (int i = 0; i < WAIT_SPINS; i++)
+    {
+        if (done()) return;
+        std::this_thread::yield();
+    }
+
+    // Sleep until another thread signals progress and the condition is met
+    std::unique_lock<std::mutex> lock(progressMutex);
+    progressWaiters++;
+    progressCond.wait(lock, done);
+    progressWaiters--;
+}
+
+void Gpu3DRenderer::signalProgress()
+{
+    // Wake up any threads waiting for scanlines or tiles so they can check their conditions
+    if (progressWaiters.load() > 0)
+    {
+        std::lock_guard<std::mutex> guard(progressMutex);
+        progressCond.notify_all();
+    }
+}
+
+void Gpu3DRenderer::runWorker(int thread)
+{
+    uint32_t frame = 0;
+
+    while (true)
     {
-        if (threads[i]) 
         {
-            threads[i]->join();
-            delete threads[i];
+            // Sleep until a new frame needs this thread, or until the pool shuts down
+            std::unique_lock<std::mutex> lock(poolMutex);
+            poolStart.wait(lock, [&] { return poolExit || (poolFrame != frame && thread < poolThreads); });
+            if (poolExit) return;
+            frame = poolFrame;
         }
+
+        // Draw this thread's share of the frame
+        if (tiled)
+            drawTiled();
+        else
+            drawThreaded(thread);
+
+        // Signal when the last thread finishes drawing
+        std::lock_guard<std::mutex> guard(poolMutex);
+        if (--poolBusy == 0)
+            poolFinish.notify_all();
     }
 }
 
@@ -55,24 +645,46 @@ uint32_t Gpu3DRenderer::rgba5ToRgba6(uint32_t color)
     return (a << 18) | (b << 12) | (g << 6) | r;
 }
 
-uint32_t *Gpu3DRenderer::getLine(int line)
+void Gpu3DRenderer::setScale(int scale)
 {
-    // Get 2 lines when high-res is enabled, to ensure they're both finished
-    if (resShift)
+    // Set the resolution scale and the precision shift needed to avoid overflow at that scale
+    resScale = scale;
+    for (scaleBits = 0; (1 << scaleBits) < scale; scaleBits++);
+    width = 256 * scale;
+    height = 192 * scale;
+
+    // Resize the buffers for the new resolution
+    for (int i = 0; i < 2; i++)
     {
-        uint32_t *data = getLine1(line * 2);
-        getLine1(line * 2 + 1);
-        return data;
+        framebuffer[i].assign(width * height, 0);
+        depthBuffer[i].assign(width * height, 0);
+        attribBuffer[i].assign(width * height, 0);
     }
+    stencilBuffer.assign(width * height, 0);
+}
 
-    return getLine1(line);
+uint32_t *Gpu3DRenderer::getLine(int line)
+{
+    // Get every scanline that makes up a native one when the resolution is scaled, to ensure they're all finished
+    uint32_t *data = getLine1(line * resScale);
+    for (int i = 1; i < resScale; i++)
+        getLine1(line * resScale + i);
+    return data;
 }
 
 uint32_t *Gpu3DRenderer::getLine1(int line)
 {
+    if (tiled)
+    {
+        // Help draw tiles while waiting for the scanline to be finished, then wait for the rest once none are left
+        while (ready[line].load() < 3 && runTileJob());
+        waitProgress([&] { return ready[line].load() >= 3; });
+        return &framebuffer[0][line * width];
+    }
+
     // If a thread is falling behind, see if this thread can help out instead of waiting around
     // Threads go back for the final pass after drawing their next scanline, so check 2 scanlines ahead
-    if (ready[line].load() < 3 && line + activeThreads * 2 < (192 << resShift))
+    if (ready[line].load() < 3 && line + activeThreads * 2 < height)
     {
         int next = line + activeThreads * 2;
         switch (ready[next].exchange(1))
@@ -94,22 +706,33 @@ uint32_t *Gpu3DRenderer::getLine1(int line)
                 ready[next].store(3);
                 break;
         }
+        signalProgress();
     }
 
     // Wait until a scanline is ready, and then return it
-    while (ready[line].load() < 3) std::this_thread::yield();
-    return &framebuffer[0][line * 256 * 2];
+    waitProgress([&] { return ready[line].load() >= 3; });
+    return &framebuffer[0][line * width];
 }
 
 void Gpu3DRenderer::drawScanline(int line)
 {
     if (line == 0)
     {
-        // Calculate the scanline bounds for each polygon
+        // Make sure the threads have finished the last frame
+        joinThreads();
+
+        // Update the resolution scale for the next frame, resizing the buffers if it changed
+        int scale = Settings::getScale3D();
+        if (scale != resScale)
+            setScale(scale);
+
+        // Calculate the scanline and horizontal bounds for each polygon
         for (int i = 0; i < core->gpu3D.getPolygonCount(); i++)
         {
-            polygonTop[i] = 192 * 2;
-            polygonBot[i] =   0 * 2;
+            polygonTop[i] = height;
+            polygonBot[i] = 0;
+            polygonLeft[i] = width;
+            polygonRight[i] = 0;
 
             _Polygon *polygon = &core->gpu3D.getPolygons()[i];
             for (int j = 0; j < polygon->size; j++)
@@ -117,62 +740,64 @@ void Gpu3DRenderer::drawScanline(int line)
                 Vertex *vertex = &polygon->vertices[j];
                 if (vertex->y < polygonTop[i]) polygonTop[i] = vertex->y;
                 if (vertex->y > polygonBot[i]) polygonBot[i] = vertex->y;
+                if (vertex->x < polygonLeft[i]) polygonLeft[i] = vertex->x;
+                if (vertex->x > polygonRight[i]) polygonRight[i] = vertex->x;
             }
 
             // Allow horizontal line polygons to be drawn
             if (polygonTop[i] == polygonBot[i]) polygonBot[i]++;
         }
 
-        // Update the resolution shift for the next frame
-        resShift = Settings::highRes3D;
-
-        // Clean up any existing threads
-        for (int i = 0; i < activeThreads; i++)
-        {
-            if (threads[i]) 
-            {
-                threads[i]->join();
-                delete threads[i];
-            }
-        }
+        // Get the decoded textures for the new frame, now that no threads are using them
+        updateTextures(true);
 
-        // Update the thread count
+        // Update the thread count; scanlines are split between at most 3 threads, but tiles can use any number
+        tiled = (Settings::tiled3D && Settings::threaded3D > 0);
         activeThreads = Settings::threaded3D;
-        if (activeThreads > 3) activeThreads = 3;
+        if (activeThreads > 3 && !tiled) activeThreads = 3;
+
+        // Sort the polygons into scanline bands if tiles aren't used
+        if (!tiled)
+            binBands();
 
         // Set up threaded 3D rendering if enabled
         if (activeThreads > 0)
         {
             // Mark the scanlines as not ready
-            int end = 192 << resShift;
-            for (int i = 0; i < end; i++)
+            for (int i = 0; i < height; i++)
                 ready[i].store(0);
 
-            // Create threads to draw the scanlines
-            for (int i = 0; i < activeThreads; i++)
-                threads[i] = new std::thread(&Gpu3DRenderer::drawThreaded, this, i);
+            // Sort the polygons into tiles if they're used
+            if (tiled)
+                binTiles();
+
+            // Add threads to the pool if there aren't enough yet
+            while ((int)threads.size() < activeThreads)
+                threads.push_back(new std::thread(&Gpu3DRenderer::runWorker, this, (int)threads.size()));
+
+            // Wake up the threads to draw the frame
+            {
+                std::lock_guard<std::mutex> guard(poolMutex);
+                poolThreads = poolBusy = activeThreads;
+                poolFrame++;
+            }
+            poolStart.notify_all();
         }
     }
 
     // Draw scanlines normally when threading is disabled
     if (activeThreads == 0)
     {
-        if (resShift)
-        {
-            // Draw two scanlines at a time when high-res is enabled
-            for (int i = line * 2; i < line * 2 + 2; i++)
-            {
-                drawScanline1(i);
-                if (i > 0) finishScanline(i - 1);
-                if (i == 383) finishScanline(383);
-            }
-        }
-        else
+        // Pick up texture slot changes right away, since nothing else is drawing
+        if (textureGeneration != textureUpdated)
+            updateTextures(false);
+
+        // Draw every scanline that makes up a native one when the resolution is scaled
+        for (int i = line * resScale; i < (line + 1) * resScale; i++)
         {
-            // Draw one scanline at a time
-            drawScanline1(line);
-            if (line > 0) finishScanline(line - 1);
-            if (line == 191) finishScanline(191);
+            drawScanline1(i);
+            if (i > 0) finishScanline(i - 1);
+            if (i == height - 1) finishScanline(i);
         }
     }
 }
@@ -182,8 +807,8 @@ void Gpu3DRenderer::drawThreaded(int thread)
     // Draw the 3D scanlines in a threaded sequence
     // The amount of scanlines skipped per thread depends on the number of active threads
     // Together, they render the entire 3D image
-    int i, end = 192 << resShift;
-    for (i = thread; i < end; i += activeThreads)
+    int i;
+    for (i = thread; i < height; i += activeThreads)
     {
         switch (ready[i].exchange(1))
         {
@@ -198,31 +823,41 @@ void Gpu3DRenderer::drawThreaded(int thread)
                 ready[i].store(2);
                 break;
         }
+        signalProgress();
 
         if (i < activeThreads) continue;
         int prev = i - activeThreads;
 
         // Wait for this thread's previous scanline and its surrounding scanlines to be drawn
-        while ((prev > 0 && ready[prev - 1].load() < 2) || ready[prev].load() < 2 || ready[prev + 1].load() < 2)
-            std::this_thread::yield();
+        waitProgress([&] { return (prev == 0 || ready[prev - 1].load() >= 2) && ready[prev].load() >= 2 &&
+            ready[prev + 1].load() >= 2; });
 
         // Finish this thread's previous scanline
         finishScanline(prev);
         ready[prev].store(3);
+        signalProgress();
     }
 
     int prev = i - activeThreads;
 
     // Wait for this thread's final scanline and its surrounding scanlines to be drawn
-    while (ready[prev - 1].load() < 2 || ready[prev].load() < 2 || (prev < 191 && ready[prev + 1].load() < 2))
-        std::this_thread::yield();
+    waitProgress([&] { return ready[prev - 1].load() >= 2 && ready[prev].load() >= 2 &&
+        (prev == height - 1 || ready[prev + 1].load() >= 2); });
 
     // Finish this thread's final scanline
     finishScanline(prev);
     ready[prev].store(3);
+    signalProgress();
 }
 
 void Gpu3DRenderer::drawScanline1(int line)
+{
+    // Draw the whole scanline, checking the polygons in its band
+    int band = line / BAND_HEIGHT;
+    drawSpan(line, 0, width, bandBins[band].data(), bandBins[band].size());
+}
+
+void Gpu3DRenderer::drawSpan(int line, uint32_t left, uint32_t right, uint16_t *indices, int count)
 {
     // Convert the clear values
     // The attribute buffer contains the polygon IDs (0-5, 6-11), transparency bit (12), fog bit (13), edge bit (14), and edge alpha (15-20)
@@ -231,8 +866,8 @@ void Gpu3DRenderer::drawScanline1(int line)
     uint32_t attrib = ((clearColor & BIT(15)) >> 2) | ((clearColor & 0x3F000000) >> 18) | ((clearColor & 0x3F000000) >> 24) |
         (0x3F << 15) | (((clearColor & 0x001F0000) && ((clearColor & 0x001F0000) >> 16) < 31) << 12);
 
-    // Clear the scanline buffers with the clear values
-    int start = line * 256 * 2, end = start + (256 << resShift);
+    // Clear the span's buffers with the clear values
+    int start = line * width + left, end = line * width + right;
     for (int i = start; i < end; i++)
     {
         framebuffer[0][i]  = color;
@@ -240,28 +875,43 @@ void Gpu3DRenderer::drawScanline1(int line)
         attribBuffer[0][i] = attrib;
     }
 
-    stencilClear[line] = false;
+    bool stencilClear = false;
 
-    std::vector<int> translucent;
-
-    // Draw the polygons
-    for (int i = 0; i < core->gpu3D.getPolygonCount(); i++)
+    // Draw the solid polygons, and then the translucent ones
+    // The polygons to check are given as a list of indices, sorted by polygon order
+    for (int pass = 0; pass < 2; pass++)
     {
-        // Skip polygons that aren't on the current scanline
-        if (line < polygonTop[i] || line >= polygonBot[i])
-            continue;
+        for (int j = 0; j < count; j++)
+        {
+            // Skip polygons that aren't on the current scanline
+            int i = indices[j];
+            if (line < polygonTop[i] || line >= polygonBot[i])
+                continue;
 
-        // Draw solid polygons and save the translucent ones for later
-        _Polygon *polygon = &core->gpu3D.getPolygons()[i];
-        if (polygon->alpha < 0x3F || polygon->textureFmt == 1 || polygon->textureFmt == 6)
-            translucent.push_back(i);
-        else
-            drawPolygon(line, i);
-    }
+            // Skip polygons that aren't drawn in the current pass
+            _Polygon *polygon = &core->gpu3D.getPolygons()[i];
+            if ((polygon->alpha < 0x3F || polygon->textureFmt == 1 || polygon->textureFmt == 6) != (pass == 1))
+                continue;
+
+            // Keep track of shadow mask polygons
+            if (polygon->mode == 3 && polygon->id == 0) // Shadow mask polygon
+            {
+                // Clear the stencil buffer at the start of a shadow mask polygon group
+                if (!stencilClear)
+                {
+                    memset(&stencilBuffer[start], 0, right - left);
+                    stencilClear = true;
+                }
+            }
+            else
+            {
+                // End a shadow mask polygon group
+                stencilClear = false;
+            }
 
-    // Draw the translucent polygons
-    for (unsigned int i = 0; i < translucent.size(); i++)
-        drawPolygon(line, translucent[i]);
+            drawPolygon(line, i, left, right);
+        }
+    }
 }
 
 void Gpu3DRenderer::finishScanline(int line)
@@ -269,30 +919,31 @@ void Gpu3DRenderer::finishScanline(int line)
     // Perform edge marking if enabled
     if (disp3DCnt & BIT(5))
     {
-        int offset = line * 256 * 2;
-        int w = (256 << resShift) - 1;
-        int h = (192 << resShift) - 1;
+        int offset = line * width;
+        int w = width - 1;
+        int h = height - 1;
 
-        for (int i = offset; i <= offset + w; i++)
+        for (int x = 0; x <= w; x++)
         {
+            int i = offset + x;
             if (attribBuffer[0][i] & BIT(14)) // Edge bit
             {
                 // Get the polygon IDs of the surrounding pixels
                 uint32_t id[4] =
                 {
-                    (((i & w) > 0) ? attribBuffer[0][i -   1] : (clearColor >> 24)) & 0x3F, // Left
-                    (((i & w) < w) ? attribBuffer[0][i +   1] : (clearColor >> 24)) & 0x3F, // Right
-                    ((line    > 0) ? attribBuffer[0][i - 512] : (clearColor >> 24)) & 0x3F, // Up
-                    ((line    < h) ? attribBuffer[0][i + 512] : (clearColor >> 24)) & 0x3F  // Down
+                    ((x    > 0) ? attribBuffer[0][i -     1] : (clearColor >> 24)) & 0x3F, // Left
+                    ((x    < w) ? attribBuffer[0][i +     1] : (clearColor >> 24)) & 0x3F, // Right
+                    ((line > 0) ? attribBuffer[0][i - width] : (clearColor >> 24)) & 0x3F, // Up
+                    ((line < h) ? attribBuffer[0][i + width] : (clearColor >> 24)) & 0x3F  // Down
                 };
 
                 // Get the depth values of the surrounding pixels
                 int32_t depth[4] =
                 {
-                    (((i & w) > 0) ? depthBuffer[0][i -   1] : ((clearDepth == 0x7FFF) ? 0xFFFFFF : (clearDepth << 9))), // Left
-                    (((i & w) < w) ? depthBuffer[0][i +   1] : ((clearDepth == 0x7FFF) ? 0xFFFFFF : (clearDepth << 9))), // Right
-                    ((line    > 0) ? depthBuffer[0][i - 512] : ((clearDepth == 0x7FFF) ? 0xFFFFFF : (clearDepth << 9))), // Up
-                    ((line    < h) ? depthBuffer[0][i + 512] : ((clearDepth == 0x7FFF) ? 0xFFFFFF : (clearDepth << 9)))  // Down
+                    ((x    > 0) ? depthBuffer[0][i -     1] : ((clearDepth == 0x7FFF) ? 0xFFFFFF : (clearDepth << 9))), // Left
+                    ((x    < w) ? depthBuffer[0][i +     1] : ((clearDepth == 0x7FFF) ? 0xFFFFFF : (clearDepth << 9))), // Right
+                    ((line > 0) ? depthBuffer[0][i - width] : ((clearDepth == 0x7FFF) ? 0xFFFFFF : (clearDepth << 9))), // Up
+                    ((line < h) ? depthBuffer[0][i + width] : ((clearDepth == 0x7FFF) ? 0xFFFFFF : (clearDepth << 9)))  // Down
                 };
 
                 // Check the surrounding pixels, and mark the edge if at least one has a different ID and greater depth
@@ -317,7 +968,7 @@ void Gpu3DRenderer::finishScanline(int line)
 
         for (int layer = 0; layer < ((disp3DCnt & BIT(4)) ? 2 : 1); layer++) // Apply to the back layer as well if anti-aliased
         {
-            int start = line * 256 * 2, end = start + (256 << resShift);
+            int start = line * width, end = start + width;
             for (int i = start; i < end; i++)
             {
                 if (attribBuffer[layer][i] & BIT(13)) // Fog bit
@@ -366,7 +1017,7 @@ void Gpu3DRenderer::finishScanline(int line)
     // Perform anti-aliasing if enabled
     if (disp3DCnt & BIT(4))
     {
-        int start = line * 256 * 2, end = start + (256 << resShift);
+        int start = line * width, end = start + width;
         for (int i = start; i < end; i++)
         {
             if (((attribBuffer[0][i] >> 15) & 0x3F) < 0x3F) // Edge not opaque
@@ -381,9 +1032,132 @@ void Gpu3DRenderer::finishScanline(int line)
     }
 }
 
+void Gpu3DRenderer::binBands()
+{
+    // Empty the bins
+    int bands = height / BAND_HEIGHT;
+    for (int i = 0; i < bands; i++)
+        bandBins[i].clear();
+
+    // Add each polygon to the bins of the bands it covers, in order
+    for (int i = 0; i < core->gpu3D.getPolygonCount(); i++)
+    {
+        if (polygonTop[i] >= height || polygonBot[i] <= 0)
+            continue;
+
+        int band1 = std::max(polygonTop[i], 0) / BAND_HEIGHT;
+        int band2 = (std::min(polygonBot[i], height) - 1) / BAND_HEIGHT;
+        for (int band = band1; band <= band2; band++)
+            bandBins[band].push_back(i);
+    }
+}
+
+void Gpu3DRenderer::binTiles()
+{
+    int count = core->gpu3D.getPolygonCount();
+
+    // Use full-width tiles if there are shadow masks, since their stencil clears depend on every polygon on a scanline
+    bool shadow = false;
+    for (int i = 0; i < count && !shadow; i++)
+    {
+        _Polygon *polygon = &core->gpu3D.getPolygons()[i];
+        shadow = (polygon->mode == 3 && polygon->id == 0);
+    }
+
+    // Set the tile layout and empty the bins
+    tileCols = shadow ? 1 : (width / TILE_WIDTH);
+    tileRows = height / TILE_HEIGHT;
+    int tileWidth = width / tileCols;
+    for (int i = 0; i < tileCols * tileRows; i++)
+        tileBins[i].clear();
+
+    // Add each polygon to the bins of the tiles it covers, in order
+    // Edge interpolation can put a span's start a pixel left of the polygon's vertices, so include that
+    for (int i = 0; i < count; i++)
+    {
+        if (polygonTop[i] >= height || polygonLeft[i] > width)
+            continue;
+
+        int row1 = polygonTop[i] / TILE_HEIGHT;
+        int row2 = (std::min(polygonBot[i], height) - 1) / TILE_HEIGHT;
+        int col1 = std::max(polygonLeft[i] - 1, 0) / tileWidth;
+        int col2 = std::min(polygonRight[i], width - 1) / tileWidth;
+
+        for (int row = row1; row <= row2; row++)
+        {
+            for (int col = col1; col <= col2; col++)
+                tileBins[row * tileCols + col].push_back(i);
+        }
+    }
+
+    // Queue the jobs, finishing each row once the row below it has been drawn
+    tileJobCount = 0;
+    for (int row = 0; row <= tileRows; row++)
+    {
+        if (row < tileRows)
+        {
+            tilesDrawn[row].store(0);
+            for (int col = 0; col < tileCols; col++)
+                tileJobs[tileJobCount++] = row * tileCols + col;
+        }
+
+        if (row > 0)
+            tileJobs[tileJobCount++] = -row;
+    }
+    nextTileJob.store(0);
+}
+
+void Gpu3DRenderer::drawTiled()
+{
+    // Run tile jobs until there are none left
+    while (runTileJob());
+}
+
+bool Gpu3DRenderer::runTileJob()
+{
+    // Take the next job, if there are any left
+    int job = nextTileJob.fetch_add(1);
+    if (job >= tileJobCount)
+        return false;
+
+    int tile = tileJobs[job];
+    if (tile >= 0)
+    {
+        // Draw the scanlines of a tile with the polygons in its bin
+        int row = tile / tileCols;
+        uint32_t tileWidth = width / tileCols;
+        uint32_t left = (tile % tileCols) * tileWidth;
+        for (int line = row * TILE_HEIGHT; line < (row + 1) * TILE_HEIGHT; line++)
+            drawSpan(line, left, left + tileWidth, tileBins[tile].data(), tileBins[tile].size());
+
+        // Mark the tile as drawn
+        tilesDrawn[row]++;
+        signalProgress();
+    }
+    else
+    {
+        // Wait for a row and the rows around it to be drawn, since finishing uses the surrounding scanlines
+        // Jobs are taken in order, so the tiles being waited on have already been taken
+        int row = -tile - 1;
+        for (int i = std::max(row - 1, 0); i <= std::min(row + 1, tileRows - 1); i++)
+            waitProgress([&] { return tilesDrawn[i].load() >= tileCols; });
+
+        // Finish the row's scanlines and mark them as ready
+        for (int line = row * TILE_HEIGHT; line < (row + 1) * TILE_HEIGHT; line++)
+        {
+            finishScanline(line);
+            ready[line].store(3);
+        }
+        signalProgress();
+    }
+
+    return true;
+}
+
 uint8_t *Gpu3DRenderer::getTexture(uint32_t address)
 {
     // Get a pointer to texture data
+    if ((address >> 17) >= 4) return nullptr;
     uint8_t *slot = core->memory.getTex3D()[address >> 17];
     return slot ? &slot[address & 0x1FFFF] : nullptr;
 }
@@ -391,6 +1165,7 @@ uint8_t *Gpu3DRenderer::getTexture(uint32_t address)
 uint8_t *Gpu3DRenderer::getPalette(uint32_t address)
 {
     // Get a pointer to palette data
+    if ((address >> 14) >= 6) return nullptr;
     uint8_t *slot = core->memory.getPal3D()[address >> 14];
     return slot ? &slot[address & 0x3FFF] : nullptr;
 }
@@ -438,50 +1213,279 @@ uint32_t Gpu3DRenderer::interpolateColor(uint32_t c1, uint32_t c2, uint32_t x1,
     return (a << 18) | (b << 12) | (g << 6) | r;
 }
 
-uint32_t Gpu3DRenderer::readTexture(_Polygon *polygon, int s, int t)
+void Gpu3DRenderer::interpolateSpanDepth(const SpanSetup &setup, uint32_t x, int count, SpanValues &out)
 {
-    // Handle S-coordinate overflows
-    if (polygon->repeatS)
+    for (int i = 0; i < count; i++, x++)
     {
-        // Flip the S-coordinate every second repeat
-        if (polygon->flipS && (s & polygon->sizeS))
-            s = -1 - s;
+        // Calculate the interpolation factor with a precision of 8 bits for polygon fills
+        uint32_t &factor = out.factor[i];
+        if (setup.linear)
+        {
+            // Fall back to linear interpolation if the W values are equal and their lower bits are clear
+            factor = -1;
+        }
+        else if (x <= setup.x1)
+        {
+            // Clamp to the minimum value
+            factor = 0;
+        }
+        else if (x >= setup.x4)
+        {
+            // Clamp to the maximum value
+            factor = (1 << 8);
+        }
+        else
+        {
+            // Adjust interpolation precision to avoid overflow at higher resolutions
+            uint32_t s = 0;
+            while (s < setup.scaleBits && ((x - setup.x1) >> (8 + s))) s++;
+            factor = (((setup.we[0] * (x - setup.x1)) << (8 - s)) /
+                (setup.we[1] * (setup.x4 - x) + setup.we[0] * (x - setup.x1))) << s;
+        }
+
+        // Calculate the depth value of the current pixel
+        if (setup.wBuffer)
+        {
+            out.depth[i] = (factor == -1) ? interpolateLinear(setup.we[0], setup.we[1], setup.x1, x, setup.x4) :
+                interpolateFactor(factor, 8, setup.we[0], setup.we[1]);
+            if (setup.wShift > 0)
+                out.depth[i] <<= setup.wShift;
+            else if (setup.wShift < 0)
+                out.depth[i] >>= -setup.wShift;
+        }
+        else
+        {
+            out.depth[i] = interpolateLinear(setup.ze[0], setup.ze[1], setup.x1, x, setup.x4);
+        }
+    }
+}
+
+void Gpu3DRenderer::interpolateSpanColor(const SpanSetup &setup, uint32_t x, int count, SpanValues &out)
+{
+    for (int i = 0; i < count; i++, x++)
+    {
+        // Interpolate the vertex color at the current pixel, reusing the factor from the depth value
+        uint32_t factor = out.factor[i];
+        uint32_t rv, gv, bv;
+        if (factor == -1)
+        {
+            rv = interpolateLinear(setup.re[0], setup.re[1], setup.x1, x, setup.x4) >> 3;
+            gv = interpolateLinear(setup.ge[0], setup.ge[1], setup.x1, x, setup.x4) >> 3;
+            bv = interpolateLinear(setup.be[0], setup.be[1], setup.x1, x, setup.x4) >> 3;
+        }
+        else
+        {
+            rv = interpolateFactor(factor, 8, setup.re[0], setup.re[1]) >> 3;
+            gv = interpolateFactor(factor, 8, setup.ge[0], setup.ge[1]) >> 3;
+            bv = interpolateFactor(factor, 8, setup.be[0], setup.be[1]) >> 3;
+        }
+        out.color[i] = (bv << 12) | (gv << 6) | rv;
 
-        // Wrap the S-coordinate
-        s &= polygon->sizeS - 1;
+        // Interpolate the texture coordinates at the current pixel
+        if (setup.textured)
+        {
+            if (factor == -1)
+            {
+                out.s[i] = (int)(interpolateLinear(setup.se[0], setup.se[1], setup.x1, x, setup.x4) - 0xFFFF) >> 4;
+                out.t[i] = (int)(interpolateLinear(setup.te[0], setup.te[1], setup.x1, x, setup.x4) - 0xFFFF) >> 4;
+            }
+            else
+            {
+                out.s[i] = (int)(interpolateFactor(factor, 8, setup.se[0], setup.se[1]) - 0xFFFF) >> 4;
+                out.t[i] = (int)(interpolateFactor(factor, 8, setup.te[0], setup.te[1]) - 0xFFFF) >> 4;
+            }
+        }
     }
-    else if (s < 0)
+}
+
+void Gpu3DRenderer::invalidateSlot(int slot)
+{
+    // Mark a texture slot (0-3) or palette slot (4-9) as changed, so textures that read from it are redecoded
+    slotGenerations[slot]++;
+    textureGeneration++;
+}
+
+void Gpu3DRenderer::invalidateTextures()
+{
+    // Mark every texture and palette slot as changed
+    for (int i = 0; i < 10; i++)
+        invalidateSlot(i);
+}
+
+void Gpu3DRenderer::updateTextures(bool newFrame)
+{
+    // Count frames so textures that are still in use aren't evicted
+    if (newFrame) textureFrame++;
+    textureUpdated = textureGeneration;
+
+    for (int i = 0; i < core->gpu3D.getPolygonCount(); i++)
     {
-        // Clamp the S-coordinate on the left
-        s = 0;
+        _Polygon *polygon = &core->gpu3D.getPolygons()[i];
+        if (polygon->textureFmt == 0)
+        {
+            polygonTextures[i] = nullptr;
+            continue;
+        }
+
+        // Pack the parameters that affect decoding into a key
+        uint64_t key = (polygon->textureAddr & 0xFFFFF) | ((uint64_t)(polygon->paletteAddr & 0x3FFFF) << 20) |
+            ((uint64_t)polygon->textureFmt << 38) | ((uint64_t)polygon->transparent0 << 41) |
+            ((uint64_t)(polygon->sizeS & 0x7FF) << 42) | ((uint64_t)(polygon->sizeT & 0x7FF) << 53);
+
+        // Leave direct color and compressed textures uncached if they run past their slot
+        // These read from a pointer to the start of the slot, so decoding the whole thing could read out of bounds
+        int size = polygon->sizeS * polygon->sizeT;
+        if (size == 0 || (polygon->textureFmt == 5 && (polygon->textureAddr & 0x1FFFF) + size / 4 > 0x20000) ||
+            (polygon->textureFmt == 7 && (polygon->textureAddr & 0x1FFFF) + size * 2 > 0x20000))
+        {
+            polygonTextures[i] = nullptr;
+            continue;
+        }
+
+        // Find the texture slots the texture data covers, based on its bits per texel
+        // Compressed textures also read from slot 1, where their palette bases are stored
+        static const uint8_t bits[] = { 0, 8, 2, 4, 8, 2, 8, 16 };
+        uint32_t start = polygon->textureAddr;
+        uint32_t end = std::min<uint32_t>(start + size * bits[polygon->textureFmt] / 8 - 1, 0x7FFFF);
+        uint16_t slots = 0;
+        for (uint32_t j = start >> 17; j <= (end >> 17); j++)
+            slots |= BIT(j);
+        if (polygon->textureFmt == 5)
+            slots |= BIT(1);
+
+        // Find the palette slots the palette covers, based on its color count
+        // Compressed textures can offset the palette by up to 64KB, and direct color textures don't use one
+        static const uint32_t palSizes[] = { 0, 0x40, 0x8, 0x20, 0x200, 0x10008, 0x10, 0 };
+        if (polygon->textureFmt != 7)
+        {
+            start = polygon->paletteAddr;
+            end = std::min<uint32_t>(start + palSizes[polygon->textureFmt] - 1, 0x17FFF);
+            for (uint32_t j = start >> 14; j <= (end >> 14); j++)
+                slots |= BIT(4 + j);
+        }
+
+        // Stamp the texture with its slots' generations, which only increase, so any change makes the sum differ
+        uint32_t stamp = 0;
+        for (int j = 0; j < 10; j++)
+            if (slots & BIT(j)) stamp += slotGenerations[j];
+
+        auto it = textureCache.find(key);
+        if (it == textureCache.end())
+        {
+            // Make room for a new texture, or leave it to be decoded per texel if the frame's textures fill the cache
+            size_t bytes = size * sizeof(uint32_t);
+            if (textureCacheSize + bytes > TEXTURE_CACHE_LIMIT)
+                evictTextures();
+            if (textureCacheSize + bytes > TEXTURE_CACHE_LIMIT)
+            {
+                polygonTextures[i] = nullptr;
+                continue;
+            }
+
+            it = textureCache.emplace(key, TextureEntry()).first;
+            it->second.texels.resize(size);
+            it->second.rows.assign(polygon->sizeT, 0);
+            it->second.slots = slots;
+            it->second.stamp = stamp;
+            textureCacheSize += bytes;
+        }
+        else if (it->second.stamp != stamp)
+        {
+            // Forget the decoded rows if a slot the texture reads from has changed
+            it->second.rows.assign(polygon->sizeT, 0);
+            it->second.stamp = stamp;
+        }
+
+        // Decode the rows the polygon can reach
+        it->second.frame = textureFrame;
+        decodeRows(&it->second, polygon);
+        polygonTextures[i] = &it->second;
     }
-    else if (s >= polygon->sizeS)
+}
+
+void Gpu3DRenderer::evictTextures()
+{
+    // Drop the textures that haven't been used in the current frame
+    for (auto it = textureCache.begin(); it != textureCache.end();)
     {
-        // Clamp the S-coordinate on the right
-        s = polygon->sizeS - 1;
+        if (it->second.frame != textureFrame)
+        {
+            textureCacheSize -= it->second.texels.size() * sizeof(uint32_t);
+            it = textureCache.erase(it);
+        }
+        else
+        {
+            it++;
+        }
     }
+}
 
-    // Handle T-coordinate overflows
-    if (polygon->repeatT)
+void Gpu3DRenderer::decodeRows(TextureEntry *entry, _Polygon *polygon)
+{
+    // Find the range of T-coordinates across the polygon's vertices, with a texel of leeway for rounding
+    // Texture coordinates are interpolated between vertices, so the polygon can't reach outside of this range
+    if (polygon->size == 0) return;
+    int top = polygon->vertices[0].t >> 4, bot = top;
+    for (int i = 1; i < polygon->size; i++)
     {
-        // Flip the T-coordinate every second repeat
-        if (polygon->flipT && (t & polygon->sizeT))
-            t = -1 - t;
+        int t = polygon->vertices[i].t >> 4;
+        if (t < top) top = t;
+        if (t > bot) bot = t;
+    }
+    top--;
+    bot++;
 
-        // Wrap the T-coordinate
-        t &= polygon->sizeT - 1;
+    // Decode every row the range wraps or clamps to; once it spans two repeats, that's all of them
+    if (bot - top + 1 >= polygon->sizeT * 2)
+    {
+        top = 0;
+        bot = polygon->sizeT - 1;
     }
-    else if (t < 0)
+
+    for (int t = top; t <= bot; t++)
     {
-        // Clamp the T-coordinate on the top
-        t = 0;
+        int row = wrapCoord(t, polygon->sizeT, polygon->repeatT, polygon->flipT);
+        if (entry->rows[row]) continue;
+
+        uint32_t *texels = &entry->texels[row * polygon->sizeS];
+        for (int s = 0; s < polygon->sizeS; s++)
+            texels[s] = decodeTexel(polygon, s, row);
+        entry->rows[row] = 1;
     }
-    else if (t >= polygon->sizeT)
+}
+
+int Gpu3DRenderer::wrapCoord(int coord, int size, bool repeat, bool flip)
+{
+    if (repeat)
     {
-        // Clamp the T-coordinate on the bottom
-        t = polygon->sizeT - 1;
+        // Flip the coordinate every second repeat
+        if (flip && (coord & size))
+            coord = -1 - coord;
+
+        // Wrap the coordinate
+        return coord & (size - 1);
     }
 
+    // Clamp the coordinate to the texture
+    return std::max(0, std::min(coord, size - 1));
+}
+
+uint32_t Gpu3DRenderer::readTexture(int polygonIndex, int s, int t)
+{
+    // Handle coordinate overflows
+    _Polygon *polygon = &core->gpu3D.getPolygons()[polygonIndex];
+    s = wrapCoord(s, polygon->sizeS, polygon->repeatS, polygon->flipS);
+    t = wrapCoord(t, polygon->sizeT, polygon->repeatT, polygon->flipT);
+
+    // Read the decoded texel from the cache if its row was decoded, or decode it directly otherwise
+    TextureEntry *entry = polygonTextures[polygonIndex];
+    if (entry && entry->rows[t])
+        return entry->texels[t * polygon->sizeS + s];
+    return decodeTexel(polygon, s, t);
+}
+
+uint32_t Gpu3DRenderer::decodeTexel(_Polygon *polygon, int s, int t)
+{
     // Decode a texel
     switch (polygon->textureFmt)
     {
@@ -675,7 +1679,7 @@ uint32_t Gpu3DRenderer::readTexture(_Polygon *polygon, int s, int t)
     }
 }
 
-void Gpu3DRenderer::drawPolygon(int line, int polygonIndex)
+void Gpu3DRenderer::drawPolygon(int line, int polygonIndex, uint32_t left, uint32_t right)
 {
     _Polygon *polygon = &core->gpu3D.getPolygons()[polygonIndex];
 
@@ -985,9 +1989,10 @@ void Gpu3DRenderer::drawPolygon(int line, int polygonIndex)
             else
             {
                 // Adjust the W values to be 15-bit so the calculation doesn't overflow
-                // Also adjust interpolation precision to avoid overflow in high-res mode
+                // Also adjust interpolation precision to avoid overflow at higher resolutions
                 uint32_t wa = (ws[i2] >> 1) + ((ws[i2] & 1) && !(ws[i2 + 1] & 1));
-                uint32_t s = (resShift & ((xe[i] - xe1[i]) >> 8));
+                uint32_t s = 0;
+                while (s < scaleBits && ((xe[i] - xe1[i]) >> (8 + s))) s++;
                 factor = ((((ws[i2] >> 1) * (xe[i] - xe1[i])) << (9 - s)) /
                     ((ws[i2 + 1] >> 1) * (xe2[i] - xe[i]) + wa * (xe[i] - xe1[i]))) << s;
             }
@@ -1008,22 +2013,6 @@ void Gpu3DRenderer::drawPolygon(int line, int polygonIndex)
         }
     }
 
-    // Keep track of shadow mask polygons
-    if (polygon->mode == 3 && polygon->id == 0) // Shadow mask polygon
-    {
-        // Clear the stencil buffer at the start of a shadow mask polygon group
-        if (!stencilClear[line])
-        {
-            memset(&stencilBuffer[line * 256 * 2], 0, 256 << resShift);
-            stencilClear[line] = true;
-        }
-    }
-    else
-    {
-        // End a shadow mask polygon group
-        stencilClear[line] = false;
-    }
-
     // Increment the right bound not only for drawing, but for interpolation across the scanline as well
     // This seems to give results accurate to hardware
     uint32_t x1e = x1, x4e = ++x4;
@@ -1041,62 +2030,59 @@ void Gpu3DRenderer::drawPolygon(int line, int polygonIndex)
     // Instead, simply consider the entire span across the top and bottom of a polygon to be an edge
     bool horizontal = (line == polygonTop[polygonIndex] || line == polygonBot[polygonIndex] - 1);
 
+    // Set up interpolation across the span, in batches of up to 8 pixels
+    SpanSetup setup;
+    setup.x1 = x1;
+    setup.x4 = x4;
+    setup.scaleBits = scaleBits;
+    setup.linear = (we[0] == we[1] && !(we[0] & 0x007F));
+    setup.wBuffer = polygon->wBuffer;
+    setup.wShift = polygon->wShift;
+    setup.textured = (polygon->textureFmt != 0);
+    for (int i = 0; i < 2; i++)
+    {
+        setup.we[i] = we[i];
+        setup.ze[i] = ze[i];
+        setup.re[i] = re[i];
+        setup.ge[i] = ge[i];
+        setup.be[i] = be[i];
+        setup.se[i] = se[i] + 0xFFFF;
+        setup.te[i] = te[i] + 0xFFFF;
+    }
+
+    SpanValues values;
+    uint32_t batchStart = 0, batchEnd = 0;
+    bool batchColored = false;
     int lastS = 0xFFFF, lastT = 0xFFFF;
     uint32_t texel;
 
-    // Draw a line segment
-    for (uint32_t x = x1; x < x4; x++)
+    // Draw a line segment, limited to the span being drawn
+    for (uint32_t x = std::max(x1, left); x < x4; x++)
     {
         // Skip the polygon interior for wireframe polygons
-        if (!horizontal && polygon->alpha == 0 && x == x2 + 1 && x3 > x2)
+        if (!horizontal && polygon->alpha == 0 && x > x2 && x < x3)
             x = x3;
 
         // Invalid viewports can cause out-of-bounds vertices, so only draw within bounds
-        if (x >= (256 << resShift))
+        if (x >= right)
             break;
 
         bool layer = 0;
-        int i = line * 256 * 2 + x;
+        int i = line * width + x;
 
-        // Calculate the interpolation factor with a precision of 8 bits for polygon fills
-        uint32_t factor;
-        if (we[0] == we[1] && !(we[0] & 0x007F))
-        {
-            // Fall back to linear interpolation if the W values are equal and their lower bits are clear
-            factor = -1;
-        }
-        else if (x <= x1)
-        {
-            // Clamp to the minimum value
-            factor = 0;
-        }
-        else if (x >= x4)
-        {
-            // Clamp to the maximum value
-            factor = (1 << 8);
-        }
-        else
+        // Interpolate depth for the next batch of pixels once the current one runs out
+        if (x >= batchEnd)
         {
-            // Adjust interpolation precision to avoid overflow in high-res mode
-            uint32_t s = (resShift & ((x - x1) >> 8));
-            factor = (((we[0] * (x - x1)) << (8 - s)) / (we[1] * (x4 - x) + we[0] * (x - x1))) << s;
+            batchStart = x;
+            batchEnd = std::min(x + 8, std::min(x4, right));
+            batchColored = false;
+            if (spanDepth)
+                spanDepth(setup, x, values);
+            else
+                interpolateSpanDepth(setup, x, batchEnd - x, values);
         }
 
-        // Calculate the depth value of the current pixel
-        int32_t depth;
-        if (polygon->wBuffer)
-        {
-            depth = (factor == -1) ? interpolateLinear(we[0], we[1], x1, x, x4) :
-                interpolateFactor(factor, 8, we[0], we[1]);
-            if (polygon->wShift > 0)
-                depth <<= polygon->wShift;
-            else if (polygon->wShift < 0)
-                depth >>= -polygon->wShift;
-        }
-        else
-        {
-            depth = interpolateLinear(ze[0], ze[1], x1, x, x4);
-        }
+        int32_t depth = values.depth[x - batchStart];
 
         // Depth test the pixel on the front layer, and on the back layer if under an anti-aliased edge
         bool depthPass[2];
@@ -1143,43 +2129,30 @@ void Gpu3DRenderer::drawPolygon(int line, int polygonIndex)
             layer = 1;
         }
 
-        // Interpolate the vertex color at the current pixel
-        uint32_t rv, gv, bv;
-        if (factor == -1)
+        // Interpolate the rest of the batch once a pixel in it is drawn
+        if (!batchColored)
         {
-            rv = interpolateLinear(re[0], re[1], x1, x, x4) >> 3;
-            gv = interpolateLinear(ge[0], ge[1], x1, x, x4) >> 3;
-            bv = interpolateLinear(be[0], be[1], x1, x, x4) >> 3;
-        }
-        else
-        {
-            rv = interpolateFactor(factor, 8, re[0], re[1]) >> 3;
-            gv = interpolateFactor(factor, 8, ge[0], ge[1]) >> 3;
-            bv = interpolateFactor(factor, 8, be[0], be[1]) >> 3;
+            batchColored = true;
+            if (spanColor)
+                spanColor(setup, batchStart, values);
+            else
+                interpolateSpanColor(setup, batchStart, batchEnd - batchStart, values);
         }
-        uint32_t color = ((polygon->alpha ? polygon->alpha : 0x3F) << 18) | (bv << 12) | (gv << 6) | rv;
+
+        // Get the interpolated vertex color at the current pixel
+        uint32_t color = ((polygon->alpha ? polygon->alpha : 0x3F) << 18) | values.color[x - batchStart];
 
         // Blend the texture with the vertex color
         if (polygon->textureFmt != 0)
         {
-            // Interpolate the texture coordinates at the current pixel
-            int s, t;
-            if (factor == -1)
-            {
-                s = (int)(interpolateLinear(se[0] + 0xFFFF, se[1] + 0xFFFF, x1, x, x4) - 0xFFFF) >> 4;
-                t = (int)(interpolateLinear(te[0] + 0xFFFF, te[1] + 0xFFFF, x1, x, x4) - 0xFFFF) >> 4;
-            }
-            else
-            {
-                s = (int)(interpolateFactor(factor, 8, se[0] + 0xFFFF, se[1] + 0xFFFF) - 0xFFFF) >> 4;
-                t = (int)(interpolateFactor(factor, 8, te[0] + 0xFFFF, te[1] + 0xFFFF) - 0xFFFF) >> 4;
-            }
+            int s = values.s[x - batchStart];
+            int t = values.t[x - batchStart];
 
             // Read a new texel from the texture if the coordinates changed
             if (s != lastS || t != lastT)
             {
                 lastS = s; lastT = t;
-                texel = readTexture(polygon, s, t);
+                texel = readTexture(polygonIndex, s, t);
             }
 
             // Apply texture blending
@@ -1379,3 +2352,38 @@ void Gpu3DRenderer::writeFogTable(int index, uint8_t value)
     fogTable[index] = value & 0x7F;
     core->gpu.invalidate3D();
 }
+
+void Gpu3DRenderer::saveState(FILE *file)
+{
+    // Write state data to the file
+    fwrite(&disp3DCnt, sizeof(disp3DCnt), 1, file);
+    fwrite(edgeColor, sizeof(edgeColor), 1, file);
+    fwrite(&clearColor, sizeof(clearColor), 1, file);
+    fwrite(&clearDepth, sizeof(clearDepth), 1, file);
+    fwrite(&fogColor, sizeof(fogColor), 1, file);
+    fwrite(&fogOffset, sizeof(fogOffset), 1, file);
+    fwrite(fogTable, sizeof(fogTable), 1, file);
+    fwrite(toonTable, sizeof(toonTable), 1, file);
+}
+
+void Gpu3DRenderer::loadState(FILE *file)
+{
+    // Read state data from the file
+    fread(&disp3DCnt, sizeof(disp3DCnt), 1, file);
+    fread(edgeColor, sizeof(edgeColor), 1, file);
+    fread(&clearColor, sizeof(clearColor), 1, file);
+    fread(&clearDepth, sizeof(clearDepth), 1, file);
+    fread(&fogColor, sizeof(fogColor), 1, file);
+    fread(&fogOffset, sizeof(fogOffset), 1, file);
+    fread(fogTable, sizeof(fogTable), 1, file);
+    fread(toonTable, sizeof(toonTable), 1, file);
+
+    // Redraw the 3D scanlines that were already drawn for the current frame, since they came from the old state
+    // 3D is drawn 48 scanlines ahead, starting at V-count 215; this relies on everything else being loaded first
+    uint16_t vCount = core->gpu.readVCount();
+    if (!core->gbaMode && (core->gpu2D[0].readDispCnt() & BIT(3)) && (vCount >= 215 || vCount < 144))
+    {
+        for (int i = 0; i < (vCount + 48) % 263; i++)
+            drawScanline(i);
+    }
+}
@@ -21,12 +21,28 @@
 #define GPU_3D_RENDERER_H
 
 #include <atomic>
+#include <condition_variable>
 #include <cstdint>
+#include <cstdio>
+#include <mutex>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
 class Core;
 struct Vertex;
 struct _Polygon;
+struct SpanSetup;
+struct SpanValues;
+
+struct TextureEntry
+{
+    std::vector<uint32_t> texels; // Decoded RGBA6 texels
+    std::vector<uint8_t> rows;    // Whether each row of texels has been decoded
+    uint16_t slots = 0;           // Texture slots (bits 0-3) and palette slots (bits 4-9) the texture reads from
+    uint32_t stamp = 0;           // Sum of the slots' generations when the rows were decoded
+    uint32_t frame = 0;           // Last frame the texture was used in
+};
 
 class Gpu3DRenderer
 {
@@ -34,9 +50,16 @@ class Gpu3DRenderer
         Gpu3DRenderer(Core *core);
         ~Gpu3DRenderer();
 
+        void saveState(FILE *file);
+        void loadState(FILE *file);
+
         void drawScanline(int line);
+        void joinThreads();
+        void invalidateSlot(int slot);
+        void invalidateTextures();
 
         uint32_t *getLine(int line);
+        int getScale() { return resScale; }
 
         uint16_t readDisp3DCnt() { return disp3DCnt; }
 
@@ -52,19 +75,67 @@ class Gpu3DRenderer
     private:
         Core *core;
 
-        bool resShift = false;
-        uint32_t framebuffer[2][256 * 192 * 4] = {};
-        int32_t depthBuffer[2][256 * 192 * 4] = {};
-        uint32_t attribBuffer[2][256 * 192 * 4] = {};
-        uint8_t stencilBuffer[256 * 192 * 4] = {};
-        bool stencilClear[256 * 2] = {};
+        // The buffers are sized for the resolution scale, which can be changed between frames
+        static const int MAX_SCALE = 8;
+        int resScale = 1;
+        uint32_t scaleBits = 0;
+        int width = 256, height = 192;
+        std::vector<uint32_t> framebuffer[2];
+        std::vector<int32_t> depthBuffer[2];
+        std::vector<uint32_t> attribBuffer[2];
+        std::vector<uint8_t> stencilBuffer;
 
         int polygonTop[2048] = {};
         int polygonBot[2048] = {};
+        int polygonLeft[2048] = {};
+        int polygonRight[2048] = {};
+
+        // Polygons are sorted into bands of scanlines each frame, so scanlines only check the polygons that can touch them
+        static const int BAND_HEIGHT = 8;
+        std::vector<uint16_t> bandBins[192 * MAX_SCALE / BAND_HEIGHT];
+
+        // Textures are decoded to RGBA6 a row at a time as polygons reach them, keyed by their parameters
+        // Texture VRAM can only change when it's remapped, so each slot counts its remaps as a generation
+        // Textures are redecoded when a slot they read from changes, and the cache is kept within a byte limit
+        static const size_t TEXTURE_CACHE_LIMIT = 0x800000;
+        std::unordered_map<uint64_t, TextureEntry> textureCache;
+        size_t textureCacheSize = 0;
+        uint32_t slotGenerations[10] = {};
+        uint32_t textureGeneration = 0, textureUpdated = 0;
+        uint32_t textureFrame = 0;
+        TextureEntry *polygonTextures[2048] = {};
 
         int activeThreads = 0;
-        std::thread *threads[3] = {};
-        std::atomic<int> ready[192 * 2];
+        std::atomic<int> ready[192 * MAX_SCALE];
+
+        // Threads waiting for scanlines or tiles from other threads sleep until progress is signaled
+        // Signaling only takes the lock if a thread is counted as waiting, so it's cheap when no one is
+        static const int WAIT_SPINS = 64;
+        std::mutex progressMutex;
+        std::condition_variable progressCond;
+        std::atomic<int> progressWaiters;
+
+        // Threads are kept for as long as the renderer exists, and wait between frames until they're needed
+        // Each frame, the first few threads in the pool are woken up, and the last one to finish signals it
+        std::vector<std::thread*> threads;
+        std::mutex poolMutex;
+        std::condition_variable poolStart, poolFinish;
+        uint32_t poolFrame = 0;
+        int poolThreads = 0;
+        int poolBusy = 0;
+        bool poolExit = false;
+
+        // Tiles are drawn in rows from top to bottom, with a job to finish each row once its neighbors are drawn
+        // Draw jobs are stored as tile indices, and finish jobs as negative row numbers starting at -1
+        static const int TILE_WIDTH = 64;
+        static const int TILE_HEIGHT = 8;
+        bool tiled = false;
+        int tileCols = 0, tileRows = 0;
+        std::vector<uint16_t> tileBins[(192 * MAX_SCALE / TILE_HEIGHT) * (256 * MAX_SCALE / TILE_WIDTH)];
+        int16_t tileJobs[(192 * MAX_SCALE / TILE_HEIGHT) * (256 * MAX_SCALE / TILE_WIDTH + 1)] = {};
+        int tileJobCount = 0;
+        std::atomic<int> nextTileJob;
+        std::atomic<int> tilesDrawn[192 * MAX_SCALE / TILE_HEIGHT];
 
         uint16_t disp3DCnt = 0;
         uint16_t edgeColor[8] = {};
@@ -77,12 +148,24 @@ class Gpu3DRenderer
 
         static uint32_t rgba5ToRgba6(uint32_t color);
 
+        void setScale(int scale);
+
         uint32_t *getLine1(int line);
 
+        template <typename F> void waitProgress(F done);
+        void signalProgress();
+
+        void runWorker(int thread);
         void drawThreaded(int thread);
         void drawScanline1(int line);
+        void drawSpan(int line, uint32_t left, uint32_t right, uint16_t *indices, int count);
         void finishScanline(int line);
 
+        void binBands();
+        void binTiles();
+        void drawTiled();
+        bool runTileJob();
+
         uint8_t *getTexture(uint32_t address);
         uint8_t *getPalette(uint32_t address);
 
@@ -90,9 +173,16 @@ class Gpu3DRenderer
         static uint32_t interpolateLinRev(uint32_t v1, uint32_t v2, uint32_t x1, uint32_t x, uint32_t x2);
         static uint32_t interpolateFactor(uint32_t factor, uint32_t shift, uint32_t v1, uint32_t v2);
         static uint32_t interpolateColor(uint32_t c1, uint32_t c2, uint32_t x1, uint32_t x, uint32_t x2);
-
-        uint32_t readTexture(_Polygon *polygon, int s, int t);
-        void drawPolygon(int line, int polygonIndex);
+        static void interpolateSpanDepth(const SpanSetup &setup, uint32_t x, int count, SpanValues &out);
+        static void interpolateSpanColor(const SpanSetup &setup, uint32_t x, int count, SpanValues &out);
+
+        void updateTextures(bool newFrame);
+        void evictTextures();
+        void decodeRows(TextureEntry *entry, _Polygon *polygon);
+        static int wrapCoord(int coord, int size, bool repeat, bool flip);
+        uint32_t decodeTexel(_Polygon *polygon, int s, int t);
+        uint32_t readTexture(int polygonIndex, int s, int t);
+        void drawPolygon(int line, int polygonIndex, uint32_t left, uint32_t right);
 };
 
 #endif // GPU_3D_RENDERER_H
@@ -0,0 +1,316 @@
+/*
+    Copyright 2019-2023 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "../batch_runner.h"
+#include "../core.h"
+#include "../settings.h"
+
+// Number of samples per audio buffer; this is more than a frame's worth, so at most one fills per frame
+#define AUDIO_SAMPLES 1024
+
+void printUsage(const char *name)
+{
+    // Print the command line options
+    fprintf(stderr, "Usage: %s [options] <rom> [<rom>...]\n", name);
+    fprintf(stderr, "  -f <count>  Number of frames to run (default 600)\n");
+    fprintf(stderr, "  -v <file>   Dump frames as raw 32-bit pixels (256x384, multiplied by the 3D scale with high-res 3D)\n");
+    fprintf(stderr, "  -a <file>   Dump audio as raw signed 16-bit stereo samples at 32768Hz\n");
+    fprintf(stderr, "  -p <file>   Dump profiling counters for each frame as CSV, or JSON lines if the name ends in .json\n");
+    fprintf(stderr, "              (only available when built with -DPROFILE)\n");
+    fprintf(stderr, "  -s <file>   Load settings from a file (default noods.ini)\n");
+    fprintf(stderr, "  -b          Benchmark each ROM and report frame time percentiles\n");
+    fprintf(stderr, "  -j <count>  Run all ROMs at once on a pool of threads (0 for one per CPU), and report\n");
+    fprintf(stderr, "              a hash of each one's last frame\n");
+    fprintf(stderr, "  -w <dir>    Write each batch ROM's save to its own file in a directory (by default, batch saves\n");
+    fprintf(stderr, "              are only kept in memory)\n");
+}
+
+bool isGbaRom(std::string romPath)
+{
+    // Treat a ROM as GBA or NDS depending on its extension
+    return (romPath.find(".gba", romPath.length() - 4) != std::string::npos);
+}
+
+void printError(CoreError e, std::string romPath)
+{
+    // Report why a core couldn't be created
+    switch (e)
+    {
+        case ERROR_BIOS: fprintf(stderr, "Error loading BIOS files; check the paths in the settings\n"); break;
+        case ERROR_FIRM: fprintf(stderr, "Error loading firmware; check the path in the settings\n"); break;
+        case ERROR_ROM:  fprintf(stderr, "Error loading ROM: %s\n", romPath.c_str()); break;
+    }
+}
+
+Core *createCore(std::string romPath)
+{
+    // Create a core, loading the ROM as NDS or GBA
+    bool gba = isGbaRom(romPath);
+    try
+    {
+        return new Core(gba ? "" : romPath, gba ? romPath : "");
+    }
+    catch (CoreError e)
+    {
+        printError(e, romPath);
+        return nullptr;
+    }
+}
+
+bool runDump(std::string romPath, int frames, FILE *videoFile, FILE *audioFile, FILE *profileFile, bool json)
+{
+    Core *core = createCore(romPath);
+    if (!core) return false;
+
+    // Start generating audio by requesting a buffer; the first one is empty, so discard it
+    if (audioFile)
+        delete[] core->spu.getSamples(AUDIO_SAMPLES);
+
+    // Allocate a frame buffer big enough for high-resolution output
+    int frameSize = 256 * 192 * 2 * Settings::getScale3D() * Settings::getScale3D();
+    uint32_t *framebuffer = new uint32_t[frameSize];
+
+    for (int i = 0; i < frames; i++)
+    {
+        // Run a frame of emulation
+        core->runFrame();
+
+        // Write the finished frame to the video dump
+        if (videoFile && core->gpu.getFrame(framebuffer, false))
+            fwrite(framebuffer, sizeof(uint32_t), frameSize, videoFile);
+
+        // Write the finished audio buffer to the audio dump
+        // Only taking ready buffers means nothing is skipped or padded, so the output is the same every run
+        if (audioFile && core->spu.isReady())
+        {
+            uint32_t *samples = core->spu.getSamples(AUDIO_SAMPLES);
+            fwrite(samples, sizeof(uint32_t), AUDIO_SAMPLES, audioFile);
+            delete[] samples;
+        }
+
+        // Write the frame's profiling counters
+        if (profileFile)
+            core->profiler.writeFrame(profileFile, json);
+    }
+
+    // Clean up
+    delete[] framebuffer;
+    delete core;
+    return true;
+}
+
+bool runBenchmark(std::string romPath, int frames)
+{
+    Core *core = createCore(romPath);
+    if (!core) return false;
+
+    // Run the frames with timing enabled
+    // Frames are still taken from the GPU so they don't pile up, but nothing is done with them
+    uint32_t *framebuffer = new uint32_t[256 * 192 * 2 * Settings::getScale3D() * Settings::getScale3D()];
+    core->benchmark.setEnabled(true);
+    for (int i = 0; i < frames; i++)
+    {
+        core->runFrame();
+        core->gpu.getFrame(framebuffer, false);
+    }
+    core->benchmark.setEnabled(false);
+
+    // Report the average and percentile times of each section
+    Benchmark &bench = core->benchmark;
+    printf("%s: %zu frames, %.1f FPS average\n", romPath.c_str(), bench.getFrameCount(), 1000 / bench.getMean(BENCH_TOTAL));
+    printf("  %-16s %9s %9s %9s %9s %9s\n", "Section (ms)", "Mean", "P50", "P90", "P99", "Max");
+    for (int i = 0; i <= BENCH_TOTAL; i++)
+    {
+        BenchSection section = BenchSection(i);
+        printf("  %-16s %9.3f %9.3f %9.3f %9.3f %9.3f\n", Benchmark::getName(section), bench.getMean(section),
+            bench.getPercentile(section, 50), bench.getPercentile(section, 90),
+            bench.getPercentile(section, 99), bench.getPercentile(section, 100));
+    }
+
+    // Clean up
+    delete[] framebuffer;
+    delete core;
+    return true;
+}
+
+bool runBatch(std::vector<std::string> &romPaths, int frames, int threads, std::string saveDir)
+{
+    // Create a core for each ROM, with files shared between them
+    BatchRunner runner(threads);
+    for (size_t i = 0; i < romPaths.size(); i++)
+    {
+        // Name saves by job index and ROM name, so the same ROM listed twice still gets separate files
+        std::string savePath;
+        if (saveDir != "")
+        {
+            std::string name = romPaths[i].substr(romPaths[i].find_last_of("/\\") + 1);
+            savePath = saveDir + "/" + std::to_string(i) + "-" + name.substr(0, name.rfind(".")) + ".sav";
+        }
+
+        bool gba = isGbaRom(romPaths[i]);
+        try
+        {
+            runner.addCore(frames, gba ? "" : romPaths[i], gba ? romPaths[i] : "", gba ? "" : savePath, gba ? savePath : "");
+        }
+        catch (CoreError e)
+        {
+            printError(e, romPaths[i]);
+            return false;
+        }
+    }
+
+    // Run every core, taking each finished frame so the last one is kept
+    int frameSize = 256 * 192 * 2 * Settings::getScale3D() * Settings::getScale3D();
+    std::vector<std::vector<uint32_t>> framebuffers(romPaths.size(), std::vector<uint32_t>(frameSize));
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    runner.run([&](int index, Core *core, int frame) { core->gpu.getFrame(&framebuffers[index][0], false); });
+    std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+
+    // Report the total speed, then an FNV-1a hash of each ROM's last frame for comparing runs
+    printf("%zu ROMs, %d frames each, %d threads: %.2f seconds, %.1f FPS total\n", romPaths.size(), frames,
+        runner.getThreadCount(), time.count(), romPaths.size() * frames / time.count());
+    for (size_t i = 0; i < romPaths.size(); i++)
+    {
+        uint64_t hash = 0xCBF29CE484222325;
+        for (int j = 0; j < frameSize; j++)
+            hash = (hash ^ framebuffers[i][j]) * 0x100000001B3;
+        printf("%016llX %s\n", (unsigned long long)hash, romPaths[i].c_str());
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<std::string> romPaths;
+    std::string videoPath, audioPath, profilePath, saveDir, settingsPath = "noods.ini";
+    int frames = 600, threads = -1;
+    bool benchmark = false;
+
+    // Parse the command line options
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg[0] != '-')
+        {
+            romPaths.push_back(arg);
+            continue;
+        }
+        else if (arg == "-b")
+        {
+            benchmark = true;
+            continue;
+        }
+        else if (i + 1 >= argc)
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+
+        if (arg == "-f")
+            frames = atoi(argv[++i]);
+        else if (arg == "-v")
+            videoPath = argv[++i];
+        else if (arg == "-a")
+            audioPath = argv[++i];
+        else if (arg == "-p")
+            profilePath = argv[++i];
+        else if (arg == "-s")
+            settingsPath = argv[++i];
+        else if (arg == "-j")
+            threads = atoi(argv[++i]);
+        else if (arg == "-w")
+            saveDir = argv[++i];
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    // Require one ROM to dump, or any number of ROMs to benchmark or batch without dumping; save directories are batch-only
+    bool batch = (threads >= 0);
+    bool dumping = (videoPath != "" || audioPath != "" || profilePath != "");
+    if (romPaths.empty() || (benchmark && batch) || (!batch && saveDir != "") ||
+        ((benchmark || batch) ? dumping : romPaths.size() > 1))
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+#ifndef PROFILE
+    // Profiling counters are compiled out unless requested, since they slow down hot paths
+    if (profilePath != "")
+    {
+        fprintf(stderr, "Profiling isn't available in this build; rebuild with -DPROFILE to enable it\n");
+        return 1;
+    }
+#endif
+
+    // Load the settings, but never save them, and run as fast as possible
+    // The FPS limiter works by syncing to audio playback, so there's nothing to limit against here
+    Settings::load(settingsPath);
+    Settings::fpsLimiter = 0;
+
+    if (benchmark)
+    {
+        // Print the settings that affect performance, then benchmark each ROM in order
+        printf("Threaded 2D: %d, Threaded 3D: %d, Tiled 3D: %d, Threaded Geometry: %d, 3D Scale: %d, JIT: %d\n",
+            Settings::threaded2D, Settings::threaded3D, Settings::tiled3D, Settings::threadedGeometry,
+            Settings::getScale3D(), Settings::jit);
+        for (size_t i = 0; i < romPaths.size(); i++)
+        {
+            if (!runBenchmark(romPaths[i], frames))
+                return 1;
+        }
+        return 0;
+    }
+
+    if (batch)
+    {
+        // Run the ROMs together, without extra threads per core since the pool already fills the CPU
+        Settings::threaded2D = 0;
+        Settings::threaded3D = 0;
+        Settings::threadedGeometry = 0;
+        return runBatch(romPaths, frames, threads, saveDir) ? 0 : 1;
+    }
+
+    // Open the dump files
+    FILE *videoFile = nullptr, *audioFile = nullptr, *profileFile = nullptr;
+    if ((videoPath != "" && !(videoFile = fopen(videoPath.c_str(), "wb"))) ||
+        (audioPath != "" && !(audioFile = fopen(audioPath.c_str(), "wb"))) ||
+        (profilePath != "" && !(profileFile = fopen(profilePath.c_str(), "w"))))
+    {
+        fprintf(stderr, "Failed to open a dump file for writing\n");
+        return 1;
+    }
+
+    // Run the ROM and close the dump files
+    bool json = (profilePath.find(".json", profilePath.length() - 5) != std::string::npos);
+    bool result = runDump(romPaths[0], frames, videoFile, audioFile, profileFile, json);
+    if (videoFile) fclose(videoFile);
+    if (audioFile) fclose(audioFile);
+    if (profileFile) fclose(profileFile);
+    return result ? 0 : 1;
+}
@@ -20,6 +20,9 @@
 #include "interpreter.h"
 #include "core.h"
 
+// Maximum number of opcodes in a decoded block
+#define MAX_BLOCK_SIZE 32
+
 Interpreter::Interpreter(Core *core, bool arm7): core(core), arm7(arm7)
 {
     // Initialize the registers for user mode
@@ -55,11 +58,14 @@ void Interpreter::directBoot()
 
 void Interpreter::resetCycles()
 {
-    // Adjust CPU cycles for a global cycle reset
+    // Adjust CPU cycles for a global cycle reset, and restart idle loop tracking
     cycles -= std::min(core->globalCycles, cycles);
+    idleBlock = nullptr;
 }
 
-void Interpreter::runNdsFrame(Core &core)
+template void Interpreter::runNdsFrame<false>(Core &core);
+template void Interpreter::runNdsFrame<true>(Core &core);
+template <bool jit> void Interpreter::runNdsFrame(Core &core)
 {
     Interpreter &arm9 = core.interpreter[0];
     Interpreter &arm7 = core.interpreter[1];
@@ -68,33 +74,33 @@ void Interpreter::runNdsFrame(Core &core)
     while (core.running.exchange(true))
     {
         // Run the CPUs until the next scheduled task
-        while (core.events[0].cycles > core.globalCycles)
+        // With the JIT, a whole block runs at once instead of a single opcode
+        // Otherwise, opcodes are stepped through one at a time from the decoded block cache
+        while (core.nextEvent > core.globalCycles)
         {
             // Run the ARM9
             if (!arm9.halted && core.globalCycles >= arm9.cycles)
-                arm9.cycles = core.globalCycles + arm9.runOpcode();
+                arm9.cycles = core.globalCycles + (jit ? arm9.runBlock() : arm9.runCached());
 
             // Run the ARM7 at half the speed of the ARM9
             if (!arm7.halted && core.globalCycles >= arm7.cycles)
-                arm7.cycles = core.globalCycles + (arm7.runOpcode() << 1);
+                arm7.cycles = core.globalCycles + ((jit ? arm7.runBlock() : arm7.runCached()) << 1);
 
             // Count cycles up to the next soonest event
             core.globalCycles = std::min<uint32_t>((arm9.halted ? -1 : arm9.cycles), (arm7.halted ? -1 : arm7.cycles));
         }
 
         // Jump to the next scheduled task
-        core.globalCycles = core.events[0].cycles;
+        core.globalCycles = core.nextEvent;
 
         // Run all tasks that are scheduled now
-        while (core.events[0].cycles <= core.globalCycles)
-        {
-            (*core.events[0].task)();
-            core.events.erase(core.events.begin());
-        }
+        core.runEvents();
     }
 }
 
-void Interpreter::runGbaFrame(Core &core)
+template void Interpreter::runGbaFrame<false>(Core &core);
+template void Interpreter::runGbaFrame<true>(Core &core);
+template <bool jit> void Interpreter::runGbaFrame(Core &core)
 {
     Interpreter &arm7 = core.interpreter[1];
 
@@ -103,18 +109,14 @@ void Interpreter::runGbaFrame(Core &core)
     {
         // Run the ARM7 until the next scheduled task
         if (arm7.cycles > core.globalCycles) core.globalCycles = arm7.cycles;
-        while (!arm7.halted && core.events[0].cycles > arm7.cycles)
-            arm7.cycles = (core.globalCycles += arm7.runOpcode());
+        while (!arm7.halted && core.nextEvent > arm7.cycles)
+            arm7.cycles = (core.globalCycles += (jit ? arm7.runBlock() : arm7.runCached()));
 
         // Jump to the next scheduled task
-        core.globalCycles = core.events[0].cycles;
+        core.globalCycles = core.nextEvent;
 
         // Run all tasks that are scheduled now
-        while (core.events[0].cycles <= core.globalCycles)
-        {
-            (*core.events[0].task)();
-            core.events.erase(core.events.begin());
-        }
+        core.runEvents();
     }
 }
 
@@ -148,6 +150,291 @@ FORCE_INLINE int Interpreter::runOpcode()
     }
 }
 
+int Interpreter::runBlock()
+{
+    // Look up the compiled block at the current PC, with bit 0 set for THUMB mode
+    // Outside of the interpreter, the PC points to the opcode after the next one to execute
+    bool thumb = cpsr & BIT(5);
+    uint32_t address = (*registers[15] - (thumb ? 2 : 4)) | thumb;
+    uint8_t *page = core->memory.getCodePage(arm7, address);
+    JitBlock *block = core->jit.getBlock(arm7, address, page);
+
+    // Compile a new block if one doesn't exist yet, and skip ahead if it's an idle loop
+    if (block || (block = compileBlock(address, page)))
+    {
+        if (int cycles = skipIdle(block))
+            return cycles;
+        return block->code();
+    }
+
+    // Fall back to the interpreter if the code can't be compiled, refilling the pipeline first
+    idleBlock = nullptr;
+    refillPipeline();
+    return runOpcode();
+}
+
+FORCE_INLINE int Interpreter::runCached()
+{
+    // Step to the next opcode in the current block if the last one didn't jump and the block is still valid
+    // Otherwise, look up the block at the current PC, decoding a new one if it doesn't exist yet
+    if (!block || *registers[15] != blockPc || core->jit.getVersion() != blockVersion || blockIndex >= block->ops.size())
+    {
+        bool thumb = cpsr & BIT(5);
+        uint32_t address = (*registers[15] - (thumb ? 2 : 4)) | thumb;
+        uint8_t *page = core->memory.getCodePage(arm7, address);
+
+        // Fall back to the interpreter if the code can't be decoded, refilling the pipeline if it's stale
+        if (!(block = core->jit.getBlock(arm7, address, page)) && !(block = compileBlock(address, page)))
+        {
+            idleBlock = nullptr;
+            if (!pipelineValid)
+            {
+                refillPipeline();
+                pipelineValid = true;
+            }
+            return runOpcode();
+        }
+
+        blockPc = *registers[15];
+        blockVersion = core->jit.getVersion();
+        blockIndex = 0;
+
+        // Skip ahead without running anything if the block is an idle loop
+        if (int cycles = skipIdle(block))
+            return cycles;
+    }
+
+    // The pipeline isn't used when running from the cache, so it needs a refill before falling back
+    const JitOp &op = block->ops[blockIndex++];
+    pipelineValid = false;
+
+    // Execute an instruction, setting the program counter as it would be after pipelining
+    if (block->address & 0x1) // THUMB mode
+    {
+        *registers[15] = (blockPc += 2);
+        return (this->*op.thumb)(op.opcode);
+    }
+    else // ARM mode
+    {
+        *registers[15] = (blockPc += 4);
+        if (!condition[op.cond | (cpsr >> 28)]) return 1;
+        return (this->*op.arm)(op.opcode);
+    }
+}
+
+JitBlock *Interpreter::compileBlock(uint32_t address, uint8_t *page)
+{
+    // Only decode code from memory that can be write-protected or is read-only
+    // VRAM and anything unmapped is left to the interpreter, as are pages that keep getting rewritten
+    if (!page || (address >= 0x4000000 && address < 0x8000000) || !core->jit.canDecode(page))
+        return nullptr;
+
+    JitBlock *block = new JitBlock();
+    block->cpu = arm7;
+    block->address = address;
+    block->page = page;
+    uint32_t pc = address & ~0x1;
+    bool idle = true;
+
+    // Decode opcodes until a branch, the end of the page, or the maximum block size is reached
+    while (block->ops.size() < MAX_BLOCK_SIZE)
+    {
+        JitOp op = {};
+        bool branch;
+
+        if (address & 0x1) // THUMB mode
+        {
+            uint16_t opcode = core->memory.read<uint16_t>(arm7, pc);
+            op.thumb = thumbInstrs[(opcode >> 6) & 0x3FF];
+            op.func = Jit::funcAddr(op.thumb);
+            op.opcode = opcode;
+            op.cond = 0xE0;
+            pc += 2;
+
+            // Check if the opcode is a branch back to the start of the block
+            uint32_t target = 0;
+            if ((opcode & 0xF000) == 0xD000 && (opcode & 0x0E00) != 0x0E00)
+                target = pc + 2 + ((int8_t)opcode << 1);
+            else if ((opcode & 0xF800) == 0xE000)
+                target = pc + 2 + ((int16_t)(opcode << 5) >> 4);
+            block->idle = (target == (address & ~0x1));
+            idle &= block->idle || isIdleOp(opcode, true);
+
+            // Check for branches, BL/BLX (not the setup half), BX/BLX, high register ops with PC, POP with PC, and SWI
+            branch = (opcode & 0xF000) == 0xD000 || ((opcode & 0xE000) == 0xE000 && (opcode & 0xF800) != 0xF000) ||
+                (opcode & 0xFF00) == 0x4700 || (opcode & 0xFC87) == 0x4487 || (opcode & 0xFF00) == 0xBD00;
+        }
+        else // ARM mode
+        {
+            // The reserved condition is handled separately, and always runs
+            uint32_t opcode = core->memory.read<uint32_t>(arm7, pc);
+            bool reserved = (opcode >> 28) == 0xF;
+            op.arm = reserved ? &Interpreter::handleReserved : armInstrs[((opcode >> 16) & 0xFF0) | ((opcode >> 4) & 0xF)];
+            op.func = Jit::funcAddr(op.arm);
+            op.opcode = opcode;
+            op.cond = reserved ? 0xE0 : ((opcode >> 24) & 0xF0);
+            pc += 4;
+
+            // Check if the opcode is a branch back to the start of the block
+            block->idle = !reserved && (opcode & 0x0F000000) == 0x0A000000 &&
+                pc + 4 + ((int32_t)(opcode << 8) >> 6) == address;
+            idle &= block->idle || isIdleOp(opcode, false);
+
+            // Check for branches, BX/BLX, SWI, LDM with PC, and data processing or LDR with PC as destination
+            branch = (opcode & 0x0E000000) == 0x0A000000 || (opcode & 0x0FFFFFD0) == 0x012FFF10 ||
+                (opcode & 0x0F000000) == 0x0F000000 || (opcode & 0x0E108000) == 0x08108000 ||
+                (opcode & 0x0C00F000) == 0x0000F000 || (opcode & 0x0C10F000) == 0x0410F000;
+        }
+
+        // Fall back to the interpreter if the JIT can't call a handler directly
+        if (core->jit.isEnabled() && !op.func)
+        {
+            delete block;
+            return nullptr;
+        }
+
+        block->ops.push_back(op);
+        if (branch || !(pc & 0xFFF)) break;
+    }
+
+    // Mark the block as idle if it loops back to its start without doing anything but reading memory
+    block->idle &= idle;
+
+    // Add the block to the cache, with pointers to the state the JIT needs to access
+    JitTarget target = { this, registers[15], &cpsr, &halted, condition,
+        &core->globalCycles, &core->nextEvent, arm7 && !core->gbaMode };
+    core->jit.addBlock(block, target);
+    return block;
+}
+
+bool Interpreter::isIdleOp(uint32_t opcode, bool thumb)
+{
+    // Check if an opcode only reads memory or changes registers, which is all an idle loop can do
+    if (thumb)
+    {
+        switch (opcode >> 12)
+        {
+            case 0x0: case 0x1: case 0x2: case 0x3: case 0xA: // Register ops and address calculations
+                return true;
+
+            case 0x4: // ALU ops, high register ops without PC, and PC-relative loads
+                if (opcode & 0x0800) return true;
+                if (!(opcode & 0x0400)) return true;
+                return (opcode & 0x0300) != 0x0300 && (opcode & 0x0087) != 0x0087;
+
+            case 0x5: // Register offset loads
+                return (opcode & 0x0800) || (opcode & 0x0E00) == 0x0600;
+
+            case 0x6: case 0x7: case 0x8: case 0x9: // Immediate offset and SP-relative loads
+                return opcode & 0x0800;
+
+            default:
+                return false;
+        }
+    }
+
+    // Reject anything that writes to the PC
+    if (((opcode >> 12) & 0xF) == 0xF)
+        return false;
+
+    // Allow loads without writeback
+    if ((opcode & 0x0C000000) == 0x04000000)
+        return (opcode & BIT(20)) && (opcode & BIT(24)) && !(opcode & BIT(21));
+    if ((opcode & 0x0E000090) == 0x00000090 && (opcode & 0x60))
+        return (opcode & BIT(20)) && (opcode & BIT(24)) && !(opcode & BIT(21));
+
+    // Allow data processing, but not multiplies, swaps, status register transfers, or other misc ops
+    if ((opcode & 0x0C000000) != 0x00000000 || (opcode & 0x0FB00000) == 0x03200000)
+        return false;
+    if (!(opcode & BIT(25)) && ((opcode & 0x90) == 0x90 || (opcode & 0x01900000) == 0x01000000))
+        return false;
+    return true;
+}
+
+int Interpreter::skipIdle(JitBlock *block)
+{
+    // Forget about the last loop if a different kind of block is running
+    if (!block->idle)
+    {
+        idleBlock = nullptr;
+        return 0;
+    }
+
+    // Find the point where something else can happen, since either an event or the other CPU can change memory
+    uint32_t limit = core->nextEvent;
+    Interpreter &other = core->interpreter[!arm7];
+    if (!core->gbaMode && !other.halted)
+        limit = std::min(limit, other.cycles);
+
+    // If the last iteration of the loop finished before anything else happened and didn't change any registers,
+    // the following iterations will run the same way until something else does happen
+    if (block == idleBlock && core->jit.getVersion() == idleVersion && core->globalCycles < idleLimit && cpsr == idleRegs[15])
+    {
+        bool same = true;
+        for (int i = 0; i < 15 && same; i++)
+            same = (*registers[i] == idleRegs[i]);
+
+        // Skip as many whole iterations as fit before that point, unless an I/O read could change without an event
+        uint32_t length = core->globalCycles - idleStart;
+        if (same && !idleIo && length && limit > core->globalCycles)
+        {
+            uint32_t skip = (limit - core->globalCycles) / length * length;
+            if (skip)
+            {
+                idleStart = core->globalCycles + skip;
+                return skip >> (arm7 && !core->gbaMode);
+            }
+        }
+    }
+
+    // Save the state at the start of the loop to compare with after an iteration
+    idleBlock = block;
+    idleVersion = core->jit.getVersion();
+    idleStart = core->globalCycles;
+    idleLimit = limit;
+    for (int i = 0; i < 15; i++)
+        idleRegs[i] = *registers[i];
+    idleRegs[15] = cpsr;
+    idleIo = false;
+    return 0;
+}
+
+void Interpreter::idleIoRead(uint32_t address)
+{
+    // Only track reads while an idle loop is being checked
+    if (!idleBlock) return;
+
+    // Allow I/O registers that only change through scheduled events, like DISPSTAT/VCOUNT, IPCSYNC, and IF
+    // Other registers can change with the cycle count (like timers) or have read side effects (like FIFOs)
+    if (core->gbaMode)
+    {
+        if ((address >= 0x4000004 && address < 0x4000008) || (address >= 0x4000202 && address < 0x4000204))
+            return;
+    }
+    else if ((address >= 0x4000004 && address < 0x4000008) || (address >= 0x4000180 && address < 0x4000184) ||
+        (address >= 0x4000214 && address < 0x4000218))
+    {
+        return;
+    }
+
+    idleIo = true;
+}
+
+void Interpreter::refillPipeline()
+{
+    // Reload the pipeline from the current program counter, without jumping
+    if (cpsr & BIT(5)) // THUMB mode
+    {
+        pipeline[0] = core->memory.read<uint16_t>(arm7, *registers[15] - 2);
+        pipeline[1] = core->memory.read<uint16_t>(arm7, *registers[15]);
+    }
+    else // ARM mode
+    {
+        pipeline[0] = core->memory.read<uint32_t>(arm7, *registers[15] - 4);
+        pipeline[1] = core->memory.read<uint32_t>(arm7, *registers[15]);
+    }
+}
+
 void Interpreter::sendInterrupt(int bit)
 {
     // Set the interrupt's request bit
@@ -192,18 +479,9 @@ int Interpreter::exception(uint8_t vector)
 void Interpreter::flushPipeline()
 {
     // Adjust the program counter and refill the pipeline after a jump
-    if (cpsr & BIT(5)) // THUMB mode
-    {
-        *registers[15] = (*registers[15] & ~0x1) + 2;
-        pipeline[0] = core->memory.read<uint16_t>(arm7, *registers[15] - 2);
-        pipeline[1] = core->memory.read<uint16_t>(arm7, *registers[15]);
-    }
-    else // ARM mode
-    {
-        *registers[15] = (*registers[15] & ~0x3) + 4;
-        pipeline[0] = core->memory.read<uint32_t>(arm7, *registers[15] - 4);
-        pipeline[1] = core->memory.read<uint32_t>(arm7, *registers[15]);
-    }
+    *registers[15] = (cpsr & BIT(5)) ? ((*registers[15] & ~0x1) + 2) : ((*registers[15] & ~0x3) + 4);
+    refillPipeline();
+    pipelineValid = true;
 }
 
 void Interpreter::setCpsr(uint32_t value, bool save)
@@ -403,3 +681,61 @@ void Interpreter::writePostFlg(uint8_t value)
     postFlg |= value & 0x01;
     if (!arm7) postFlg = (postFlg & ~0x02) | (value & 0x02);
 }
+
+void Interpreter::saveState(FILE *file)
+{
+    // Write state data to the file
+    fwrite(pipeline, sizeof(pipeline), 1, file);
+    fwrite(&pipelineValid, sizeof(pipelineValid), 1, file);
+    fwrite(registersUsr, sizeof(registersUsr), 1, file);
+    fwrite(registersFiq, sizeof(registersFiq), 1, file);
+    fwrite(registersSvc, sizeof(registersSvc), 1, file);
+    fwrite(registersAbt, sizeof(registersAbt), 1, file);
+    fwrite(registersIrq, sizeof(registersIrq), 1, file);
+    fwrite(registersUnd, sizeof(registersUnd), 1, file);
+    fwrite(&cpsr, sizeof(cpsr), 1, file);
+    fwrite(&spsrFiq, sizeof(spsrFiq), 1, file);
+    fwrite(&spsrSvc, sizeof(spsrSvc), 1, file);
+    fwrite(&spsrAbt, sizeof(spsrAbt), 1, file);
+    fwrite(&spsrIrq, sizeof(spsrIrq), 1, file);
+    fwrite(&spsrUnd, sizeof(spsrUnd), 1, file);
+    fwrite(&halted, sizeof(halted), 1, file);
+    fwrite(&cycles, sizeof(cycles), 1, file);
+    fwrite(&ime, sizeof(ime), 1, file);
+    fwrite(&ie, sizeof(ie), 1, file);
+    fwrite(&irf, sizeof(irf), 1, file);
+    fwrite(&postFlg, sizeof(postFlg), 1, file);
+}
+
+void Interpreter::loadState(FILE *file)
+{
+    // Read state data from the file
+    uint32_t value;
+    fread(pipeline, sizeof(pipeline), 1, file);
+    fread(&pipelineValid, sizeof(pipelineValid), 1, file);
+    fread(registersUsr, sizeof(registersUsr), 1, file);
+    fread(registersFiq, sizeof(registersFiq), 1, file);
+    fread(registersSvc, sizeof(registersSvc), 1, file);
+    fread(registersAbt, sizeof(registersAbt), 1, file);
+    fread(registersIrq, sizeof(registersIrq), 1, file);
+    fread(registersUnd, sizeof(registersUnd), 1, file);
+    fread(&value, sizeof(value), 1, file);
+    fread(&spsrFiq, sizeof(spsrFiq), 1, file);
+    fread(&spsrSvc, sizeof(spsrSvc), 1, file);
+    fread(&spsrAbt, sizeof(spsrAbt), 1, file);
+    fread(&spsrIrq, sizeof(spsrIrq), 1, file);
+    fread(&spsrUnd, sizeof(spsrUnd), 1, file);
+    fread(&halted, sizeof(halted), 1, file);
+    fread(&cycles, sizeof(cycles), 1, file);
+    fread(&ime, sizeof(ime), 1, file);
+    fread(&ie, sizeof(ie), 1, file);
+    fread(&irf, sizeof(irf), 1, file);
+    fread(&postFlg, sizeof(postFlg), 1, file);
+
+    // Set the CPSR from an invalid mode so the banked registers are always swapped in
+    cpsr = 0;
+    setCpsr(value);
+
+    // Forget any cached block, since the code it came from was replaced
+    block = idleBlock = nullptr;
+}
@@ -20,24 +20,30 @@
 #ifndef INTERPRETER_H
 #define INTERPRETER_H
 
+#include <cstddef>
 #include <cstdint>
+#include <cstdio>
 
 #include "defines.h"
 
 class Core;
 class Bios;
+struct JitBlock;
 
 class Interpreter
 {
     public:
         Interpreter(Core *core, bool arm7);
 
+        void saveState(FILE *file);
+        void loadState(FILE *file);
+
         void init();
         void directBoot();
         void resetCycles();
 
-        static void runNdsFrame(Core &core);
-        static void runGbaFrame(Core &core);
+        template <bool jit> static void runNdsFrame(Core &core);
+        template <bool jit> static void runGbaFrame(Core &core);
 
         void halt(int bit)   { halted |=  BIT(bit); }
         void unhalt(int bit) { halted &= ~BIT(bit); }
@@ -48,6 +54,7 @@ class Interpreter
         uint32_t getPC()   { return *registers[15]; }
 
         void setBios(Bios *bios) { this->bios = bios; }
+        void idleIoRead(uint32_t address);
         int handleHleIrq();
 
         uint8_t  readIme()     { return ime;     }
@@ -66,6 +73,19 @@ class Interpreter
 
         Bios *bios = nullptr;
         uint32_t pipeline[2] = {};
+        bool pipelineValid = false;
+
+        JitBlock *block = nullptr;
+        uint32_t blockPc = 0;
+        uint32_t blockVersion = 0;
+        size_t blockIndex = 0;
+
+        JitBlock *idleBlock = nullptr;
+        uint32_t idleVersion = 0;
+        uint32_t idleStart = 0;
+        uint32_t idleLimit = 0;
+        uint32_t idleRegs[16] = {};
+        bool idleIo = false;
 
         uint32_t *registers[32]   = {};
         uint32_t registersUsr[16] = {};
@@ -92,6 +112,13 @@ class Interpreter
         static const uint8_t bitCount[0x100];
 
         int runOpcode();
+        int runBlock();
+        int runCached();
+        JitBlock *compileBlock(uint32_t address, uint8_t *page);
+        bool isIdleOp(uint32_t opcode, bool thumb);
+        int skipIdle(JitBlock *block);
+        void refillPipeline();
+
         int exception(uint8_t vector);
         void flushPipeline();
         void setCpsr(uint32_t value, bool save = false);
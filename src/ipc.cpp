@@ -143,3 +143,56 @@ uint32_t Ipc::readIpcFifoRecv(bool cpu)
 
     return ipcFifoRecv[cpu];
 }
+
+void Ipc::saveState(FILE *file)
+{
+    // Write the FIFOs to the file
+    for (int i = 0; i < 2; i++)
+    {
+        std::queue<uint32_t> fifo = fifos[i];
+        uint8_t size = fifo.size();
+        fwrite(&size, sizeof(size), 1, file);
+        for (; !fifo.empty(); fifo.pop())
+            fwrite(&fifo.front(), sizeof(uint32_t), 1, file);
+    }
+
+    // Write state data to the file
+    fwrite(ipcSync, sizeof(ipcSync), 1, file);
+    fwrite(ipcFifoCnt, sizeof(ipcFifoCnt), 1, file);
+    fwrite(ipcFifoRecv, sizeof(ipcFifoRecv), 1, file);
+}
+
+void Ipc::loadState(FILE *file)
+{
+    // Read the FIFOs from the file
+    for (int i = 0; i < 2; i++)
+    {
+        uint8_t size = 0;
+        fread(&size, sizeof(size), 1, file);
+        fifos[i] = std::queue<uint32_t>();
+        for (int j = 0; j < size; j++)
+        {
+            uint32_t value = 0;
+            fread(&value, sizeof(value), 1, file);
+            fifos[i].push(value);
+        }
+    }
+
+    // Read state data from the file
+    fread(ipcSync, sizeof(ipcSync), 1, file);
+    fread(ipcFifoCnt, sizeof(ipcFifoCnt), 1, file);
+    fread(ipcFifoRecv, sizeof(ipcFifoRecv), 1, file);
+}
+
+bool Ipc::checkState(FILE *file)
+{
+    // Check that the FIFOs aren't bigger than the 16 words they can hold
+    for (int i = 0; i < 2; i++)
+    {
+        uint8_t size = 0;
+        if (fread(&size, sizeof(size), 1, file) != 1 || size > 16)
+            return false;
+        fseek(file, size * sizeof(uint32_t), SEEK_CUR);
+    }
+    return true;
+}
@@ -0,0 +1,347 @@
+/*
+    Copyright 2019-2023 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+
+#include "jit.h"
+#include "core.h"
+#include "settings.h"
+
+#ifdef JIT_X64
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+// Handlers are called as plain functions with the interpreter as the first argument
+// Make sure member function pointers have the layout that Jit::funcAddr expects
+static_assert(sizeof(void*) == 8, "The JIT needs a 64-bit host");
+#ifdef _MSC_VER
+static_assert(sizeof(int (Interpreter::*)(uint32_t)) == sizeof(void*), "Unexpected member function pointer layout");
+#else
+static_assert(sizeof(int (Interpreter::*)(uint32_t)) == sizeof(void*) * 2, "Unexpected member function pointer layout");
+#endif
+#endif
+
+// Size of the executable code buffer, which is flushed when it fills up
+#define CODE_SIZE (32 * 1024 * 1024)
+
+// Number of times a page can be rewritten before its code is left to the interpreter
+#define MAX_PAGE_WRITES 32
+
+Jit::Jit(Core *core): core(core)
+{
+#ifdef JIT_X64
+    // Only allocate executable memory if the JIT is enabled
+    if (!Settings::jit)
+        return;
+
+    // Allocate a buffer that can be both written and executed
+#ifdef _WIN32
+    codeBuffer = (uint8_t*)VirtualAlloc(nullptr, CODE_SIZE, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+#else
+    codeBuffer = (uint8_t*)mmap(nullptr, CODE_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (codeBuffer == MAP_FAILED) codeBuffer = nullptr;
+#endif
+
+    // Fall back to the interpreter if executable memory isn't available
+    if (!codeBuffer)
+    {
+        LOG("Failed to allocate JIT code buffer; falling back to the interpreter\n");
+        return;
+    }
+
+    codeSize = CODE_SIZE;
+    enabled = true;
+#endif
+}
+
+Jit::~Jit()
+{
+    // Clean up the blocks
+    for (int i = 0; i < 2; i++)
+        for (auto it = blocks[i].begin(); it != blocks[i].end(); it++)
+            delete it->second;
+    for (size_t i = 0; i < retired.size(); i++)
+        delete retired[i];
+
+#ifdef JIT_X64
+    // Free the code buffer
+    if (codeBuffer)
+    {
+#ifdef _WIN32
+        VirtualFree(codeBuffer, 0, MEM_RELEASE);
+#else
+        munmap(codeBuffer, codeSize);
+#endif
+    }
+#endif
+}
+
+JitBlock *Jit::getBlock(bool cpu, uint32_t address, uint8_t *page)
+{
+    // Check the direct-mapped cache first, then the full block map
+    // Blocks are only valid if their address still maps to the memory they were compiled from
+    JitBlock *&entry = cache[cpu][(address >> 1) & 0xFFF];
+    if (entry && entry->address == address && entry->page == page)
+        return entry;
+
+    auto it = blocks[cpu].find(address);
+    if (it == blocks[cpu].end() || it->second->page != page)
+        return nullptr;
+    return entry = it->second;
+}
+
+bool Jit::canDecode(uint8_t *page)
+{
+    // Leave code on pages that keep getting rewritten to the plain interpreter
+    auto it = pageWrites.find(page);
+    return it == pageWrites.end() || it->second < MAX_PAGE_WRITES;
+}
+
+void Jit::addBlock(JitBlock *block, JitTarget &target)
+{
+    // Free blocks that were invalidated, now that none of them can be executing
+    freeRetired();
+
+    // Compile the block to native code if the JIT is enabled
+    if (enabled)
+        compile(block, target);
+
+    // Register the block, replacing any stale block at the same address
+    auto it = blocks[block->cpu].find(block->address);
+    if (it != blocks[block->cpu].end())
+    {
+        std::vector<JitBlock*> &stale = pageBlocks[it->second->page];
+        stale.erase(std::find(stale.begin(), stale.end(), it->second));
+        retire(it->second);
+    }
+    blocks[block->cpu][block->address] = block;
+    cache[block->cpu][(block->address >> 1) & 0xFFF] = block;
+
+    // Track the block by page, and protect the page from writes when it gets its first block
+    std::vector<JitBlock*> &pageList = pageBlocks[block->page];
+    if (pageList.empty())
+        core->memory.protectCode(block->page);
+    pageList.push_back(block);
+}
+
+void Jit::compile(JitBlock *block, JitTarget &target)
+{
+#ifdef JIT_X64
+    // Flush everything if the code buffer is running out of space
+    // Each instruction emits less than 128 bytes, with a bit of overhead per block
+    int count = block->ops.size();
+    if (codeUsed + count * 128 + 64 > codeSize)
+        flush();
+
+    uint8_t *start = &codeBuffer[codeUsed];
+    std::vector<size_t> exits;
+
+    // Save the callee-saved registers that are used, and align the stack
+    emit8(0x53);                          // push rbx
+    emit8(0x55);                          // push rbp
+    emit8(0x41); emit8(0x54);             // push r12
+    emit8(0x41); emit8(0x55);             // push r13
+    emit8(0x41); emit8(0x56);             // push r14
+    emit8(0x41); emit8(0x57);             // push r15
+#ifdef _WIN32
+    emit8(0x48); emit8(0x83); emit8(0xEC); emit8(0x28); // sub rsp,40 (includes shadow space)
+#else
+    emit8(0x48); emit8(0x83); emit8(0xEC); emit8(0x08); // sub rsp,8
+#endif
+
+    // Load the CPU state pointers and clear the cycle count
+    emit8(0x48); emit8(0xBB); emit64((uintptr_t)target.cpu);       // mov rbx,cpu
+    emit8(0x49); emit8(0xBC); emit64((uintptr_t)target.pc);        // mov r12,pc
+    emit8(0x49); emit8(0xBD); emit64((uintptr_t)target.cpsr);      // mov r13,cpsr
+    emit8(0x49); emit8(0xBE); emit64((uintptr_t)target.halted);    // mov r14,halted
+    emit8(0x49); emit8(0xBF); emit64((uintptr_t)target.condition); // mov r15,condition
+    emit8(0x31); emit8(0xED);                                      // xor ebp,ebp
+
+    JitOp *ops = &block->ops[0];
+    uint32_t address = block->address;
+    bool thumb = address & 0x1;
+    for (int i = 0; i < count; i++)
+    {
+        // Set the program counter as it would be after pipelining
+        uint32_t pc = (address & ~0x1) + (i << (thumb ? 1 : 2)) + (thumb ? 4 : 8);
+        emit8(0x41); emit8(0xC7); emit8(0x04); emit8(0x24); emit32(pc); // mov dword [r12],pc
+
+        size_t skip = 0;
+        if (ops[i].cond != 0xE0)
+        {
+            // Look up the condition based on the current flags
+            emit8(0x41); emit8(0x8B); emit8(0x45); emit8(0x00);                // mov eax,[r13]
+            emit8(0xC1); emit8(0xE8); emit8(28);                               // shr eax,28
+            emit8(0x0D); emit32(ops[i].cond);                               // or eax,cond
+            emit8(0x41); emit8(0x0F); emit8(0xB6); emit8(0x04); emit8(0x07);  // movzx eax,byte [r15+rax]
+            emit8(0x85); emit8(0xC0);                                          // test eax,eax
+
+            // If the condition fails, count a cycle and skip the instruction
+            emit8(0x75); emit8(0x08);                   // jnz +8
+            emit8(0x83); emit8(0xC5); emit8(0x01);      // add ebp,1
+            emit8(0xE9); emit32(0);                     // jmp skip
+            skip = codeUsed;
+        }
+
+        // Call the interpreter handler for the instruction
+#ifdef _WIN32
+        emit8(0x48); emit8(0x89); emit8(0xD9);          // mov rcx,rbx
+        emit8(0xBA); emit32(ops[i].opcode);             // mov edx,opcode
+#else
+        emit8(0x48); emit8(0x89); emit8(0xDF);          // mov rdi,rbx
+        emit8(0xBE); emit32(ops[i].opcode);             // mov esi,opcode
+#endif
+        emit8(0x48); emit8(0xB8); emit64((uintptr_t)ops[i].func); // mov rax,func
+        emit8(0xFF); emit8(0xD0);                       // call rax
+        emit8(0x01); emit8(0xC5);                       // add ebp,eax
+
+        // Leave the block if the program counter changed or the CPU halted
+        emit8(0x41); emit8(0x81); emit8(0x3C); emit8(0x24); emit32(pc); // cmp dword [r12],pc
+        emit8(0x0F); emit8(0x85); emit32(0);            // jne exit
+        exits.push_back(codeUsed);
+        emit8(0x41); emit8(0x80); emit8(0x3E); emit8(0x00); // cmp byte [r14],0
+        emit8(0x0F); emit8(0x85); emit32(0);            // jne exit
+        exits.push_back(codeUsed);
+
+        // Resolve the skip jump for conditional instructions
+        if (skip)
+        {
+            uint32_t offset = codeUsed - skip;
+            memcpy(&codeBuffer[skip - 4], &offset, sizeof(offset));
+        }
+
+        // Leave the block once the next event is due, so it runs on time
+        // The deadline is reloaded every time, since handlers can schedule new events
+        if (i == count - 1) continue;
+        emit8(0x48); emit8(0xB8); emit64((uintptr_t)target.nextEvent);    // mov rax,nextEvent
+        emit8(0x8B); emit8(0x08);                                          // mov ecx,[rax]
+        emit8(0x48); emit8(0xB8); emit64((uintptr_t)target.globalCycles); // mov rax,globalCycles
+        emit8(0x2B); emit8(0x08);                                          // sub ecx,[rax]
+        emit8(0x89); emit8(0xE8);                                          // mov eax,ebp
+        if (target.halfSpeed)
+        {
+            emit8(0x01); emit8(0xC0);                                      // add eax,eax
+        }
+        emit8(0x39); emit8(0xC8);                                          // cmp eax,ecx
+        emit8(0x0F); emit8(0x8D); emit32(0);                               // jge exit
+        exits.push_back(codeUsed);
+    }
+
+    // Resolve the exit jumps now that the epilogue location is known
+    for (size_t i = 0; i < exits.size(); i++)
+    {
+        uint32_t offset = codeUsed - exits[i];
+        memcpy(&codeBuffer[exits[i] - 4], &offset, sizeof(offset));
+    }
+
+    // Return the cycle count and restore the saved registers
+    emit8(0x89); emit8(0xE8);                           // mov eax,ebp
+#ifdef _WIN32
+    emit8(0x48); emit8(0x83); emit8(0xC4); emit8(0x28); // add rsp,40
+#else
+    emit8(0x48); emit8(0x83); emit8(0xC4); emit8(0x08); // add rsp,8
+#endif
+    emit8(0x41); emit8(0x5F);                           // pop r15
+    emit8(0x41); emit8(0x5E);                           // pop r14
+    emit8(0x41); emit8(0x5D);                           // pop r13
+    emit8(0x41); emit8(0x5C);                           // pop r12
+    emit8(0x5D);                                        // pop rbp
+    emit8(0x5B);                                        // pop rbx
+    emit8(0xC3);                                        // ret
+
+    block->code = (int(*)())start;
+#endif
+}
+
+void Jit::invalidate(uint8_t *page)
+{
+    // Remove all blocks that were compiled from a page
+    auto it = pageBlocks.find(page);
+    if (it != pageBlocks.end())
+    {
+        for (size_t i = 0; i < it->second.size(); i++)
+            retire(it->second[i]);
+        pageBlocks.erase(it);
+    }
+
+    // Restore write access to the page and count the rewrite
+    core->memory.unprotectCode(page);
+    pageWrites[page]++;
+}
+
+void Jit::freeRetired()
+{
+    // Delete blocks that are no longer in use
+    for (size_t i = 0; i < retired.size(); i++)
+        delete retired[i];
+    retired.clear();
+}
+
+void Jit::flush()
+{
+    // Remove all blocks and restore write access to their pages
+    for (auto it = pageBlocks.begin(); it != pageBlocks.end(); it++)
+    {
+        for (size_t i = 0; i < it->second.size(); i++)
+            retire(it->second[i]);
+        core->memory.unprotectCode(it->first);
+    }
+
+    // Reset the code buffer and give rewritten pages another chance
+    pageBlocks.clear();
+    pageWrites.clear();
+    codeUsed = 0;
+}
+
+void Jit::retire(JitBlock *block)
+{
+    // Unlink a block so it can't be run again, and queue it to be deleted
+    auto it = blocks[block->cpu].find(block->address);
+    if (it != blocks[block->cpu].end() && it->second == block)
+        blocks[block->cpu].erase(it);
+    JitBlock *&entry = cache[block->cpu][(block->address >> 1) & 0xFFF];
+    if (entry == block) entry = nullptr;
+    retired.push_back(block);
+
+    // Let the interpreters know that any block they're stepping through may be gone
+    version++;
+}
+
+void Jit::emit8(uint8_t value)
+{
+    // Write a byte to the code buffer
+    codeBuffer[codeUsed++] = value;
+}
+
+void Jit::emit32(uint32_t value)
+{
+    // Write a 32-bit value to the code buffer, LSB first
+    for (int i = 0; i < 4; i++)
+        emit8(value >> (i * 8));
+}
+
+void Jit::emit64(uint64_t value)
+{
+    // Write a 64-bit value to the code buffer, LSB first
+    for (int i = 0; i < 8; i++)
+        emit8(value >> (i * 8));
+}
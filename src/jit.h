@@ -0,0 +1,127 @@
+/*
+    Copyright 2019-2023 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef JIT_H
+#define JIT_H
+
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#include "interpreter.h"
+
+// The JIT is a threaded-code backend: blocks become x86-64 code that calls the interpreter's handlers directly
+// This removes decoding and dispatch, but instructions aren't translated to native ALU or memory operations
+// The calls rely on the member function pointer layout of the Itanium C++ ABI (GCC/Clang) or MSVC
+#if (defined(__x86_64__) || defined(_M_X64)) && (defined(__GNUC__) || defined(_MSC_VER))
+#define JIT_X64
+#endif
+
+class Core;
+
+struct JitOp
+{
+    int (Interpreter::*arm)(uint32_t);   // ARM handler, for running without native code
+    int (Interpreter::*thumb)(uint16_t); // THUMB handler, for running without native code
+    void *func;                          // Plain address of the handler, for native calls
+    uint32_t opcode;                     // Opcode passed to the handler
+    uint8_t cond;                        // ARM condition code in bits 7-4; 0xE0 means always execute
+};
+
+struct JitTarget
+{
+    void *cpu;                // Interpreter that the handlers belong to
+    uint32_t *pc;             // Program counter register
+    uint32_t *cpsr;           // Status register, for condition checks
+    uint8_t *halted;          // Halt flags, checked after every instruction
+    const uint8_t *condition; // Condition lookup table
+    uint32_t *globalCycles;   // Current time, for checking the event deadline
+    uint32_t *nextEvent;      // Time of the next scheduled event
+    bool halfSpeed;           // Whether the CPU's cycles count double, like the ARM7 in NDS mode
+};
+
+struct JitBlock
+{
+    bool cpu;                // CPU the block was decoded for
+    uint32_t address;        // Start address, with bit 0 set for THUMB
+    uint8_t *page;           // Host memory page the code was read from
+    std::vector<JitOp> ops;  // Decoded opcodes
+    bool idle = false;       // Whether the block is a loop that only reads memory and branches to itself
+    int (*code)() = nullptr; // Native code, if compiled; returns the cycles taken
+};
+
+class Jit
+{
+    public:
+        Jit(Core *core);
+        ~Jit();
+
+        bool isEnabled() { return enabled; }
+
+        JitBlock *getBlock(bool cpu, uint32_t address, uint8_t *page);
+        void addBlock(JitBlock *block, JitTarget &target);
+        bool canDecode(uint8_t *page);
+        uint32_t getVersion() { return version; }
+
+        void invalidate(uint8_t *page);
+        void freeRetired();
+        void flush();
+
+        template <typename T> static void *funcAddr(T func);
+
+    private:
+        Core *core;
+        bool enabled = false;
+        uint32_t version = 0;
+
+        uint8_t *codeBuffer = nullptr;
+        size_t codeSize = 0;
+        size_t codeUsed = 0;
+
+        std::unordered_map<uint32_t, JitBlock*> blocks[2];
+        std::unordered_map<uint8_t*, std::vector<JitBlock*>> pageBlocks;
+        std::unordered_map<uint8_t*, int> pageWrites;
+        std::vector<JitBlock*> retired;
+        JitBlock *cache[2][0x1000] = {};
+
+        void compile(JitBlock *block, JitTarget &target);
+        void retire(JitBlock *block);
+
+        void emit8(uint8_t value);
+        void emit32(uint32_t value);
+        void emit64(uint64_t value);
+};
+
+template <typename T> void *Jit::funcAddr(T func)
+{
+    // Extract a plain function address from a member function pointer
+    // MSVC uses a bare pointer, while the Itanium ABI pairs it with a this-adjustment
+    void *data[2] = {};
+    memcpy(data, &func, sizeof(T) < sizeof(data) ? sizeof(T) : sizeof(data));
+    if (sizeof(T) == sizeof(void*))
+        return data[0];
+
+    // Virtual functions and adjusted pointers can't be called directly
+    if (((uintptr_t)data[0] & 0x1) || data[1])
+        return nullptr;
+    return data[0];
+}
+
+#endif // JIT_H
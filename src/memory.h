@@ -21,6 +21,11 @@
 #define MEMORY_H
 
 #include <cstdint>
+#include <cstdio>
+#include <initializer_list>
+#include <string>
+#include <unordered_set>
+#include <vector>
 
 #include "defines.h"
 
@@ -30,22 +35,57 @@ class VramMapping
 {
     public:
         void add(uint8_t *mapping);
+        void reset() { count = 0; }
+
+        void combine(uint32_t size);
+        bool shares(VramMapping *other);
+        void refresh(uint32_t address, uint32_t size);
 
         template <typename T> T read(uint32_t address);
         template <typename T> void write(uint32_t address, T value);
 
-        uint8_t *getBaseMapping() { return mappings[0]; }
-        int      getCount()       { return count;       }
+        uint8_t *getBaseMapping() { return mappings[0];    }
+        uint8_t *getCombined()    { return &combined[0];   }
+        int      getCount()       { return count;          }
 
     private:
         uint8_t *mappings[7];
         int count = 0;
+
+        // All the mappings ORed together, kept up to date while more than one is mapped
+        std::vector<uint8_t> combined;
+};
+
+struct IoRegister
+{
+    uint32_t address; // Address of the first byte
+    uint32_t size;    // Size in bytes
+    uint32_t (*func)(Core *core, uint32_t base, uint32_t mask, uint32_t data); // Read or write function
+};
+
+class IoTable
+{
+    public:
+        IoTable(std::initializer_list<IoRegister> list);
+        template <typename T> IoRegister *find(uint32_t address);
+
+    private:
+        // Entries are kept for each access width, indexed by aligned address within a page
+        // An entry points to the register containing the whole access, so accesses spanning registers have none
+        std::vector<IoRegister> registers;
+        std::vector<uint16_t> entries[3];
+        uint8_t pages[0x10000] = {};
 };
 
 class Memory
 {
     public:
-        Memory(Core *core): core(core) {};
+        Memory(Core *core);
+        ~Memory();
+
+        void saveState(FILE *file);
+        void loadState(FILE *file);
+        bool checkState(FILE *file);
 
         bool loadBios9();
         bool loadBios7();
@@ -57,6 +97,16 @@ class Memory
         template <typename T> T read(bool cpu, uint32_t address, bool tcm = true);
         template <typename T> void write(bool cpu, uint32_t address, T value, bool tcm = true);
 
+        void protectCode(uint8_t *page);
+        void unprotectCode(uint8_t *page);
+
+        uint8_t *getCodePage(bool cpu, uint32_t address)
+            { return (cpu ? readMap7 : readMap9A)[address >> 24][(address >> 12) & 0xFFF]; }
+        uint8_t *getReadBlock(bool cpu, uint32_t address)
+            { return (cpu ? readMap7 : readMap9B)[address >> 24][(address >> 12) & 0xFFF]; }
+        uint8_t *getWriteBlock(bool cpu, uint32_t address)
+            { return (cpu ? writeMap7 : writeMap9B)[address >> 24][(address >> 12) & 0xFFF]; }
+
         uint8_t  *getPalette()    { return palette;    }
         uint8_t  *getOam()        { return oam;        }
         uint8_t **getEngAExtPal() { return engAExtPal; }
@@ -67,13 +117,21 @@ class Memory
     private:
         Core *core;
 
-        // 32-bit address space, split into 4KB blocks
-        uint8_t *readMap9A[0x100000]  = {};
-        uint8_t *readMap9B[0x100000]  = {};
-        uint8_t *readMap7[0x100000]   = {};
-        uint8_t *writeMap9A[0x100000] = {};
-        uint8_t *writeMap9B[0x100000] = {};
-        uint8_t *writeMap7[0x100000]  = {};
+        // 32-bit address space, split into 16MB regions of 4KB blocks
+        // Regions with nothing mapped share an empty table, and only get their own once something is mapped
+        static uint8_t *emptyRegion[0x1000];
+        uint8_t **readMap9A[0x100];
+        uint8_t **readMap9B[0x100];
+        uint8_t **readMap7[0x100];
+        uint8_t **writeMap9A[0x100];
+        uint8_t **writeMap9B[0x100];
+        uint8_t **writeMap7[0x100];
+
+        // Write map entries below 0x4000000 that are disabled to catch writes to cached code
+        uint8_t *codeMap9A[0x4000] = {};
+        uint8_t *codeMap9B[0x4000] = {};
+        uint8_t *codeMap7[0x4000]  = {};
+        std::unordered_set<uint8_t*> codePages;
 
         uint8_t bios9[0x8000]   = {}; // 32KB ARM9 BIOS
         uint8_t bios7[0x4000]   = {}; // 16KB ARM7 BIOS
@@ -104,6 +162,7 @@ class Memory
         VramMapping engBObj[8];
         VramMapping lcdc[64];
         VramMapping vram7[2];
+        std::vector<VramMapping*> combinedVram;
 
         uint8_t *engAExtPal[5] = {};
         uint8_t *engBExtPal[5] = {};
@@ -113,14 +172,27 @@ class Memory
         uint8_t *lastGbaBios = nullptr;
 
         uint32_t dmaFill[4] = {};
+        static const uint8_t vramCntMasks[9];
         uint8_t vramCnt[9] = {};
         uint8_t vramStat = 0;
         uint8_t wramCnt = 0;
         uint8_t haltCnt = 0;
 
+        bool loadBios(std::string path, uint8_t *bios, size_t size);
+        void mapBlock(uint8_t **map[], uint32_t address, uint8_t *block);
+        bool writeCode(bool cpu, uint32_t address, bool tcm);
+        void updateVram();
+        void updateCombined(VramMapping *mapping, uint32_t address, uint32_t size);
+
         template <typename T> T readFallback(bool cpu, uint32_t address);
         template <typename T> void writeFallback(bool cpu, uint32_t address, T value);
 
+        static IoTable ioReadTable9, ioReadTable7, ioReadTableGba;
+        static IoTable ioWriteTable9, ioWriteTable7, ioWriteTableGba;
+
+        template <typename T> T ioRead(IoTable &table, const char *name, uint32_t address);
+        template <typename T> void ioWrite(IoTable &table, const char *name, uint32_t address, T value);
+
         template <typename T> T ioRead9(uint32_t address);
         template <typename T> T ioRead7(uint32_t address);
         template <typename T> T ioReadGba(uint32_t address);
@@ -141,6 +213,15 @@ class Memory
         void writeGbaHaltCnt(uint8_t value);
 };
 
+template <typename T> FORCE_INLINE IoRegister *IoTable::find(uint32_t address)
+{
+    // Get the register containing an access of a given width, or null if there isn't one
+    // Addresses in pages without registers point to an empty page at the start
+    int shift = (sizeof(T) == 4) ? 2 : (sizeof(T) - 1);
+    uint16_t index = entries[shift][(pages[(address >> 12) & 0xFFFF] << (12 - shift)) | ((address & 0xFFF) >> shift)];
+    return index ? &registers[index - 1] : nullptr;
+}
+
 template uint8_t  Memory::read(bool cpu, uint32_t address, bool tcm);
 template uint16_t Memory::read(bool cpu, uint32_t address, bool tcm);
 template uint32_t Memory::read(bool cpu, uint32_t address, bool tcm);
@@ -149,11 +230,11 @@ template <typename T> FORCE_INLINE T Memory::read(bool cpu, uint32_t address, bo
     // Align the address
     address &= ~(sizeof(T) - 1);
 
-    uint8_t **readMap = (cpu == 0) ? (tcm ? readMap9A : readMap9B) : readMap7;
-    if (readMap[address >> 12])
+    uint8_t ***readMap = (cpu == 0) ? (tcm ? readMap9A : readMap9B) : readMap7;
+    if (uint8_t *block = readMap[address >> 24][(address >> 12) & 0xFFF])
     {
         // Get a pointer to readable memory mapped to the given address
-        uint8_t *data = &readMap[address >> 12][address & 0xFFF];
+        uint8_t *data = &block[address & 0xFFF];
 
         // Form an LSB-first value from the data at the pointer
         T value = 0;
@@ -173,11 +254,11 @@ template <typename T> FORCE_INLINE void Memory::write(bool cpu, uint32_t address
     // Align the address
     address &= ~(sizeof(T) - 1);
 
-    uint8_t **writeMap = (cpu == 0) ? (tcm ? writeMap9A : writeMap9B) : writeMap7;
-    if (writeMap[address >> 12])
+    uint8_t ***writeMap = (cpu == 0) ? (tcm ? writeMap9A : writeMap9B) : writeMap7;
+    if (uint8_t *block = writeMap[address >> 24][(address >> 12) & 0xFFF])
     {
         // Get a pointer to writable memory mapped to the given address
-        uint8_t *data = &writeMap[address >> 12][address & 0xFFF];
+        uint8_t *data = &block[address & 0xFFF];
 
         // Write an LSB-first value to the data at the pointer
         for (size_t i = 0; i < sizeof(T); i++)
@@ -185,6 +266,10 @@ template <typename T> FORCE_INLINE void Memory::write(bool cpu, uint32_t address
         return;
     }
 
+    // Invalidate cached code if the page was protected, and retry now that it's writable
+    if (address < 0x4000000 && !codePages.empty() && writeCode(cpu, address, tcm))
+        return write<T>(cpu, address, value, tcm);
+
     return writeFallback<T>(cpu, address, value);
 }
 
@@ -0,0 +1,190 @@
+/*
+    Copyright 2019-2023 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cstring>
+
+#include "profiler.h"
+#include "core.h"
+
+// Names of the scheduler tasks, in the same order as the SchedTask enum
+static const char *taskNames[] =
+{
+    "RESET_CYCLES", "CART9_WORD_READY", "CART7_WORD_READY",
+    "DMA9_TRANSFER0", "DMA9_TRANSFER1", "DMA9_TRANSFER2", "DMA9_TRANSFER3",
+    "DMA7_TRANSFER0", "DMA7_TRANSFER1", "DMA7_TRANSFER2", "DMA7_TRANSFER3",
+    "NDS_SCANLINE256", "NDS_SCANLINE355", "GBA_SCANLINE240", "GBA_SCANLINE308",
+    "GPU3D_COMMAND", "ARM9_INTERRUPT", "ARM7_INTERRUPT", "NDS_SPU_SAMPLE", "GBA_SPU_SAMPLE",
+    "TIMER9_OVERFLOW0", "TIMER9_OVERFLOW1", "TIMER9_OVERFLOW2", "TIMER9_OVERFLOW3",
+    "TIMER7_OVERFLOW0", "TIMER7_OVERFLOW1", "TIMER7_OVERFLOW2", "TIMER7_OVERFLOW3",
+    "WIFI_COUNT_MS"
+};
+
+static_assert(sizeof(taskNames) / sizeof(taskNames[0]) == MAX_TASKS, "Task names don't match the SchedTask enum");
+
+ProfileTimer::~ProfileTimer()
+{
+    // Add the time since the timer was created to its counter
+    counter.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+}
+
+Profiler::Profiler(Core *core): core(core)
+{
+    // Make a counter for each scheduler task
+    tasks.resize(MAX_TASKS);
+}
+
+void Profiler::writeFrame(FILE *file, bool json)
+{
+    // Write the counters for the current frame as CSV rows or a JSON line, then start the next frame
+    json ? writeJson(file) : writeCsv(file);
+    reset();
+    frame++;
+}
+
+void Profiler::reset()
+{
+    // Clear all of the counters
+    for (int i = 0; i < 2; i++)
+        readFallback[i] = writeFallback[i] = ProfileCounter();
+    ioReads9.clear();
+    ioWrites9.clear();
+    std::fill(tasks.begin(), tasks.end(), ProfileCounter());
+    memset(dmaUnits, 0, sizeof(dmaUnits));
+    std::fill(gxCommands, gxCommands + 0x100, ProfileCounter());
+}
+
+static const char *separator(bool &first)
+{
+    // Get the text to put before a JSON entry, which is a comma for all but the first
+    if (!first) return ",";
+    first = false;
+    return "";
+}
+
+static std::vector<std::pair<uint32_t, uint64_t>> sortedCounts(std::unordered_map<uint32_t, uint64_t> &counts)
+{
+    // Get map entries sorted by key, so output is the same every run
+    std::vector<std::pair<uint32_t, uint64_t>> sorted(counts.begin(), counts.end());
+    std::sort(sorted.begin(), sorted.end());
+    return sorted;
+}
+
+void Profiler::writeCsv(FILE *file)
+{
+    // Write the header before the first frame
+    if (frame == 0)
+        fprintf(file, "frame,counter,key,count,nanoseconds\n");
+
+    // Write a row for each counter that was hit, with the time if it's tracked
+    for (int i = 0; i < 2; i++)
+    {
+        if (readFallback[i].count)
+            fprintf(file, "%u,readFallback,arm%d,%llu,%llu\n", frame, i ? 7 : 9,
+                (unsigned long long)readFallback[i].count, (unsigned long long)readFallback[i].nanoseconds);
+        if (writeFallback[i].count)
+            fprintf(file, "%u,writeFallback,arm%d,%llu,%llu\n", frame, i ? 7 : 9,
+                (unsigned long long)writeFallback[i].count, (unsigned long long)writeFallback[i].nanoseconds);
+    }
+    for (auto &entry : sortedCounts(ioReads9))
+        fprintf(file, "%u,ioRead9,0x%08X,%llu,\n", frame, entry.first, (unsigned long long)entry.second);
+    for (auto &entry : sortedCounts(ioWrites9))
+        fprintf(file, "%u,ioWrite9,0x%08X,%llu,\n", frame, entry.first, (unsigned long long)entry.second);
+    for (int i = 0; i < MAX_TASKS; i++)
+    {
+        if (tasks[i].count)
+            fprintf(file, "%u,task,%s,%llu,%llu\n", frame, taskNames[i],
+                (unsigned long long)tasks[i].count, (unsigned long long)tasks[i].nanoseconds);
+    }
+    for (int i = 0; i < 8; i++)
+    {
+        if (dmaUnits[i >> 2][i & 3])
+            fprintf(file, "%u,dmaUnits,arm%d_dma%d,%llu,\n", frame, (i >> 2) ? 7 : 9, i & 3,
+                (unsigned long long)dmaUnits[i >> 2][i & 3]);
+    }
+    for (int i = 0; i < 0x100; i++)
+    {
+        if (gxCommands[i].count)
+            fprintf(file, "%u,gxCommand,0x%02X,%llu,%llu\n", frame, i,
+                (unsigned long long)gxCommands[i].count, (unsigned long long)gxCommands[i].nanoseconds);
+    }
+}
+
+void Profiler::writeJson(FILE *file)
+{
+    // Write the frame as a single JSON object on its own line, leaving out counters that weren't hit
+    // Timed counters are objects with a count and time, and untimed counters are plain numbers
+    bool first = true;
+    fprintf(file, "{\"frame\":%u,\"readFallback\":{", frame);
+    for (int i = 0; i < 2; i++)
+    {
+        if (!readFallback[i].count) continue;
+        fprintf(file, "%s\"arm%d\":{\"count\":%llu,\"ns\":%llu}", separator(first), i ? 7 : 9,
+            (unsigned long long)readFallback[i].count, (unsigned long long)readFallback[i].nanoseconds);
+    }
+
+    first = true;
+    fprintf(file, "},\"writeFallback\":{");
+    for (int i = 0; i < 2; i++)
+    {
+        if (!writeFallback[i].count) continue;
+        fprintf(file, "%s\"arm%d\":{\"count\":%llu,\"ns\":%llu}", separator(first), i ? 7 : 9,
+            (unsigned long long)writeFallback[i].count, (unsigned long long)writeFallback[i].nanoseconds);
+    }
+
+    first = true;
+    fprintf(file, "},\"ioRead9\":{");
+    for (auto &entry : sortedCounts(ioReads9))
+        fprintf(file, "%s\"0x%08X\":%llu", separator(first), entry.first, (unsigned long long)entry.second);
+
+    first = true;
+    fprintf(file, "},\"ioWrite9\":{");
+    for (auto &entry : sortedCounts(ioWrites9))
+        fprintf(file, "%s\"0x%08X\":%llu", separator(first), entry.first, (unsigned long long)entry.second);
+
+    first = true;
+    fprintf(file, "},\"tasks\":{");
+    for (int i = 0; i < MAX_TASKS; i++)
+    {
+        if (!tasks[i].count) continue;
+        fprintf(file, "%s\"%s\":{\"count\":%llu,\"ns\":%llu}", separator(first), taskNames[i],
+            (unsigned long long)tasks[i].count, (unsigned long long)tasks[i].nanoseconds);
+    }
+
+    first = true;
+    fprintf(file, "},\"dmaUnits\":{");
+    for (int i = 0; i < 8; i++)
+    {
+        if (!dmaUnits[i >> 2][i & 3]) continue;
+        fprintf(file, "%s\"arm%d_dma%d\":%llu", separator(first), (i >> 2) ? 7 : 9, i & 3,
+            (unsigned long long)dmaUnits[i >> 2][i & 3]);
+    }
+
+    first = true;
+    fprintf(file, "},\"gxCommands\":{");
+    for (int i = 0; i < 0x100; i++)
+    {
+        if (!gxCommands[i].count) continue;
+        fprintf(file, "%s\"0x%02X\":{\"count\":%llu,\"ns\":%llu}", separator(first), i,
+            (unsigned long long)gxCommands[i].count, (unsigned long long)gxCommands[i].nanoseconds);
+    }
+
+    fprintf(file, "}}\n");
+}
@@ -0,0 +1,73 @@
+/*
+    Copyright 2019-2023 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <unordered_map>
+#include <vector>
+
+class Core;
+
+struct ProfileCounter
+{
+    uint64_t count = 0;       // Number of times something happened
+    uint64_t nanoseconds = 0; // Time spent on it, if timed
+};
+
+class ProfileTimer
+{
+    public:
+        ProfileTimer(ProfileCounter &counter):
+            counter(counter), start(std::chrono::steady_clock::now()) { counter.count++; }
+        ~ProfileTimer();
+
+    private:
+        ProfileCounter &counter;
+        std::chrono::steady_clock::time_point start;
+};
+
+class Profiler
+{
+    public:
+        Profiler(Core *core);
+
+        ProfileCounter readFallback[2];
+        ProfileCounter writeFallback[2];
+        std::unordered_map<uint32_t, uint64_t> ioReads9;
+        std::unordered_map<uint32_t, uint64_t> ioWrites9;
+        std::vector<ProfileCounter> tasks;
+        uint64_t dmaUnits[2][4] = {};
+        ProfileCounter gxCommands[0x100];
+
+        void writeFrame(FILE *file, bool json);
+        void reset();
+
+    private:
+        Core *core;
+        uint32_t frame = 0;
+
+        void writeCsv(FILE *file);
+        void writeJson(FILE *file);
+};
+
+#endif // PROFILER_H
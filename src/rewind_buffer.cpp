@@ -0,0 +1,216 @@
+/*
+    Copyright 2019-2023 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+
+#include "rewind_buffer.h"
+#include "core.h"
+#include "settings.h"
+
+// States are passed through memory with fmemopen, except where it isn't available
+// Windows doesn't have it, and Android only does starting with API 23, so they use a temporary file instead
+#if defined(_WIN32) || (defined(__ANDROID__) && __ANDROID_API__ < 23)
+#define REWIND_TMPFILE
+#endif
+
+RewindBuffer::~RewindBuffer()
+{
+    // Close the temporary state file
+    if (file) fclose(file);
+}
+
+bool RewindBuffer::writeState(std::vector<uint64_t> &state)
+{
+#ifdef REWIND_TMPFILE
+    // Open a temporary file to pass states through, since save states are written to files
+    if (!file && !(file = tmpfile()))
+    {
+        LOG("Failed to open a temporary file for the rewind buffer\n");
+        Settings::rewind = 0;
+        return false;
+    }
+
+    // Save the current state and read it back as 64-bit words, padding the end with zeros
+    rewind(file);
+    core->saveStates.saveState(file);
+    size_t size = ftell(file);
+    state.assign((size + 7) / 8, 0);
+    rewind(file);
+    return fread(state.data(), sizeof(uint8_t), size, file) == size;
+#else
+    // Save the current state directly into memory, starting with room for a state the size of the last one
+    // If the state doesn't fit, grow the buffer and try again
+    size_t capacity = std::max<size_t>(current.size() + 0x2000, 0x20000);
+    while (true)
+    {
+        state.assign(capacity, 0);
+        FILE *file = fmemopen(state.data(), capacity * sizeof(uint64_t), "wb");
+        if (!file)
+        {
+            LOG("Failed to open a memory buffer for the rewind buffer\n");
+            Settings::rewind = 0;
+            return false;
+        }
+
+        // Trim the buffer to 64-bit words, padded with zeros, once it's known that the state fit
+        bool result = core->saveStates.saveState(file) && !fflush(file);
+        size_t size = ftell(file);
+        fclose(file);
+        if (result && size < capacity * sizeof(uint64_t))
+        {
+            state.resize((size + 7) / 8);
+            return true;
+        }
+        capacity *= 2;
+    }
+#endif
+}
+
+void RewindBuffer::readState(std::vector<uint64_t> &state)
+{
+#ifdef REWIND_TMPFILE
+    // Load a state by passing it through the temporary file
+    rewind(file);
+    fwrite(state.data(), sizeof(uint64_t), state.size(), file);
+    rewind(file);
+    core->saveStates.loadState(file);
+#else
+    // Load a state directly from memory
+    if (FILE *file = fmemopen(state.data(), state.size() * sizeof(uint64_t), "rb"))
+    {
+        core->saveStates.loadState(file);
+        fclose(file);
+    }
+#endif
+}
+
+void RewindBuffer::capture()
+{
+    // Free everything if rewinding was disabled
+    if (!Settings::rewind)
+    {
+        if (!current.empty()) clear();
+        return;
+    }
+
+    // Only capture a state every few frames
+    if (++frameCount < Settings::rewindFrames)
+        return;
+    frameCount = 0;
+
+    // Save the current state as 64-bit words
+    std::vector<uint64_t> state;
+    if (!writeState(state))
+        return;
+
+    // Store the previous state as the difference from the new one
+    // Most memory is untouched between captures, so this is much smaller than a full state
+    if (!current.empty())
+    {
+        deltas.push_back(std::vector<uint64_t>());
+        encode(current, state, deltas.back());
+        totalSize += deltas.back().size() * sizeof(uint64_t);
+    }
+
+    // Make the new state current
+    totalSize += (state.size() - current.size()) * sizeof(uint64_t);
+    current.swap(state);
+    restored = false;
+
+    // Drop the oldest states until everything fits in the memory budget
+    size_t limit = (size_t)std::max(Settings::rewindMemory, 1) << 20;
+    while (totalSize > limit && !deltas.empty())
+    {
+        totalSize -= deltas.front().size() * sizeof(uint64_t);
+        deltas.pop_front();
+    }
+}
+
+void RewindBuffer::stepBack()
+{
+    // Rewinding needs a state to go back to
+    if (current.empty())
+        return;
+
+    // Reconstruct the state before the current one if the current one was already restored
+    // When the oldest state is reached, it stays current and is restored every time
+    if (restored && !deltas.empty())
+    {
+        totalSize -= (current.size() + deltas.back().size()) * sizeof(uint64_t);
+        decode(deltas.back(), current);
+        totalSize += current.size() * sizeof(uint64_t);
+        deltas.pop_back();
+    }
+
+    // Load the current state
+    readState(current);
+    frameCount = 0;
+    restored = true;
+}
+
+void RewindBuffer::clear()
+{
+    // Free all of the stored states
+    std::vector<uint64_t>().swap(current);
+    deltas.clear();
+    totalSize = 0;
+    frameCount = 0;
+    restored = false;
+}
+
+void RewindBuffer::encode(std::vector<uint64_t> &older, std::vector<uint64_t> &newer, std::vector<uint64_t> &delta)
+{
+    // Start the delta with the size of the older state
+    size_t size = std::max(older.size(), newer.size());
+    delta.push_back(older.size());
+
+    // Run-length encode the XOR of the two states, treating missing words as zero
+    // Each run is stored as a word with the count of unchanged words in the high half and changed words
+    // in the low half, followed by the XORed values of the changed words
+    for (size_t i = 0; i < size;)
+    {
+        size_t start = i;
+        while (i < size && (i < older.size() ? older[i] : 0) == (i < newer.size() ? newer[i] : 0)) i++;
+        size_t same = i - start;
+
+        start = i;
+        while (i < size && (i < older.size() ? older[i] : 0) != (i < newer.size() ? newer[i] : 0)) i++;
+        delta.push_back(((uint64_t)same << 32) | (i - start));
+
+        for (size_t j = start; j < i; j++)
+            delta.push_back((j < older.size() ? older[j] : 0) ^ (j < newer.size() ? newer[j] : 0));
+    }
+}
+
+void RewindBuffer::decode(std::vector<uint64_t> &delta, std::vector<uint64_t> &state)
+{
+    // Turn a state into the older one by applying the XOR runs from a delta
+    size_t size = delta[0];
+    state.resize(std::max(state.size(), size), 0);
+
+    for (size_t i = 0, j = 1; j < delta.size();)
+    {
+        i += delta[j] >> 32;
+        uint32_t count = delta[j++];
+        while (count--)
+            state[i++] ^= delta[j++];
+    }
+
+    state.resize(size);
+}
@@ -0,0 +1,62 @@
+/*
+    Copyright 2019-2023 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef REWIND_BUFFER_H
+#define REWIND_BUFFER_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <vector>
+
+class Core;
+
+class RewindBuffer
+{
+    public:
+        RewindBuffer(Core *core): core(core), rewinding(false) {}
+        ~RewindBuffer();
+
+        bool isRewinding() { return rewinding.load(); }
+        void setRewinding(bool value) { rewinding.store(value); }
+
+        void capture();
+        void stepBack();
+        void clear();
+
+    private:
+        Core *core;
+        std::atomic<bool> rewinding;
+
+        FILE *file = nullptr; // Only used where states can't be passed through memory
+        int frameCount = 0;
+        bool restored = false;
+
+        std::vector<uint64_t> current;
+        std::deque<std::vector<uint64_t>> deltas;
+        size_t totalSize = 0;
+
+        bool writeState(std::vector<uint64_t> &state);
+        void readState(std::vector<uint64_t> &state);
+        static void encode(std::vector<uint64_t> &older, std::vector<uint64_t> &newer, std::vector<uint64_t> &delta);
+        static void decode(std::vector<uint64_t> &delta, std::vector<uint64_t> &state);
+};
+
+#endif // REWIND_BUFFER_H
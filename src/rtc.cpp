@@ -249,4 +249,40 @@ uint16_t Rtc::readGpData()
     bool sio = (gpDirection & BIT(1)) ? 0 : sioCur;
     bool sck = (gpDirection & BIT(0)) ? 0 : sckCur;
     return (cs << 2) | (sio << 1) | (sck << 0);
-}
\ No newline at end of file
+}
+
+void Rtc::saveState(FILE *file)
+{
+    // Write state data to the file
+    fwrite(&gpRtc, sizeof(gpRtc), 1, file);
+    fwrite(&csCur, sizeof(csCur), 1, file);
+    fwrite(&sckCur, sizeof(sckCur), 1, file);
+    fwrite(&sioCur, sizeof(sioCur), 1, file);
+    fwrite(&writeCount, sizeof(writeCount), 1, file);
+    fwrite(&command, sizeof(command), 1, file);
+    fwrite(&control, sizeof(control), 1, file);
+    fwrite(dateTime, sizeof(dateTime), 1, file);
+    fwrite(&rtc, sizeof(rtc), 1, file);
+    fwrite(&gpDirection, sizeof(gpDirection), 1, file);
+    fwrite(&gpControl, sizeof(gpControl), 1, file);
+}
+
+void Rtc::loadState(FILE *file)
+{
+    // Read state data from the file
+    fread(&gpRtc, sizeof(gpRtc), 1, file);
+    fread(&csCur, sizeof(csCur), 1, file);
+    fread(&sckCur, sizeof(sckCur), 1, file);
+    fread(&sioCur, sizeof(sioCur), 1, file);
+    fread(&writeCount, sizeof(writeCount), 1, file);
+    fread(&command, sizeof(command), 1, file);
+    fread(&control, sizeof(control), 1, file);
+    fread(dateTime, sizeof(dateTime), 1, file);
+    fread(&rtc, sizeof(rtc), 1, file);
+    fread(&gpDirection, sizeof(gpDirection), 1, file);
+    fread(&gpControl, sizeof(gpControl), 1, file);
+
+    // Update the GBA ROM mapping, which depends on the GPIO state
+    if (core->gbaMode)
+        core->memory.updateMap7(0x8000000, 0x8001000);
+}
@@ -21,6 +21,7 @@
 #define RTC_H
 
 #include <cstdint>
+#include <cstdio>
 
 #include "defines.h"
 
@@ -31,6 +32,9 @@ class Rtc
     public:
         Rtc(Core *core): core(core) {}
 
+        void saveState(FILE *file);
+        void loadState(FILE *file);
+
         void enableGpRtc() { gpRtc = true; }
         void reset();
 
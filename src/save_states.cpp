@@ -0,0 +1,215 @@
+/*
+    Copyright 2019-2023 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <cstring>
+
+#include "save_states.h"
+#include "core.h"
+
+// Tag at the start of every state, followed by the version, mode, size of the component data, and section offsets
+// The version should be bumped whenever the layout of any component's state changes
+const char SaveStates::stateTag[8] = { 'N', 'O', 'O', 'D', 'S', 'S', 'T', 'A' };
+const uint32_t SaveStates::stateVersion = 3;
+
+bool SaveStates::saveState(std::string path)
+{
+    // Open a state file and write to it
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file) return false;
+    bool result = saveState(file);
+    fclose(file);
+    return result;
+}
+
+bool SaveStates::saveState(FILE *file)
+{
+    // Write the state header, with placeholders for the data size and section offsets
+    uint8_t gbaMode = core->gbaMode;
+    uint64_t size = 0;
+    uint32_t offsets[SECTION_COUNT] = {};
+    fwrite(stateTag, sizeof(char), 8, file);
+    fwrite(&stateVersion, sizeof(stateVersion), 1, file);
+    fwrite(&gbaMode, sizeof(gbaMode), 1, file);
+    long sizePos = ftell(file);
+    fwrite(&size, sizeof(size), 1, file);
+    fwrite(offsets, sizeof(uint32_t), SECTION_COUNT, file);
+    long start = ftell(file);
+
+    // Write the state of every component, in the same order they're loaded
+    // The offsets of components that get checked on load are recorded along the way
+    core->gpu3D.saveState(file);
+    for (int i = 0; i < 3; i++)
+        core->bios[i].saveState(file);
+    offsets[SECTION_CARTRIDGE_NDS] = ftell(file) - start;
+    core->cartridgeNds.saveState(file);
+    offsets[SECTION_CARTRIDGE_GBA] = ftell(file) - start;
+    core->cartridgeGba.saveState(file);
+    offsets[SECTION_CP15] = ftell(file) - start;
+    core->cp15.saveState(file);
+    core->divSqrt.saveState(file);
+    for (int i = 0; i < 2; i++)
+        core->dma[i].saveState(file);
+    core->gpu.saveState(file);
+    for (int i = 0; i < 2; i++)
+        core->gpu2D[i].saveState(file);
+    for (int i = 0; i < 2; i++)
+        core->interpreter[i].saveState(file);
+    offsets[SECTION_IPC] = ftell(file) - start;
+    core->ipc.saveState(file);
+    offsets[SECTION_MEMORY] = ftell(file) - start;
+    core->memory.saveState(file);
+    core->rtc.saveState(file);
+    core->spi.saveState(file);
+    offsets[SECTION_SPU] = ftell(file) - start;
+    core->spu.saveState(file);
+    offsets[SECTION_TIMERS9] = ftell(file) - start;
+    core->timers[0].saveState(file);
+    offsets[SECTION_TIMERS7] = ftell(file) - start;
+    core->timers[1].saveState(file);
+    core->wifi.saveState(file);
+    core->gpu3DRenderer.saveState(file);
+    offsets[SECTION_CORE] = ftell(file) - start;
+    core->saveState(file);
+
+    // Fill in the data size and section offsets, so a state can be checked before anything is loaded
+    long end = ftell(file);
+    if (sizePos < 0 || start < 0 || end < start) return false;
+    size = end - start;
+    if (fseek(file, sizePos, SEEK_SET)) return false;
+    fwrite(&size, sizeof(size), 1, file);
+    fwrite(offsets, sizeof(uint32_t), SECTION_COUNT, file);
+    if (fseek(file, end, SEEK_SET)) return false;
+    return !ferror(file);
+}
+
+StateResult SaveStates::loadState(std::string path)
+{
+    // Open a state file and read from it
+    FILE *file = fopen(path.c_str(), "rb");
+    if (!file) return STATE_FILE_FAIL;
+    StateResult result = loadState(file);
+    fclose(file);
+    return result;
+}
+
+bool SaveStates::checkState(FILE *file, long start, uint32_t *offsets, uint64_t size)
+{
+    // Check the values in each section that are used as sizes, indices, or to rebuild the memory maps
+    for (int i = 0; i < SECTION_COUNT; i++)
+    {
+        if (offsets[i] >= size || fseek(file, start + offsets[i], SEEK_SET))
+            return false;
+
+        bool valid;
+        switch (i)
+        {
+            case SECTION_CARTRIDGE_NDS: valid = core->cartridgeNds.checkState(file); break;
+            case SECTION_CARTRIDGE_GBA: valid = core->cartridgeGba.checkState(file); break;
+            case SECTION_CP15:          valid = core->cp15.checkState(file);         break;
+            case SECTION_IPC:           valid = core->ipc.checkState(file);          break;
+            case SECTION_MEMORY:        valid = core->memory.checkState(file);       break;
+            case SECTION_SPU:           valid = core->spu.checkState(file);          break;
+            case SECTION_TIMERS9:       valid = core->timers[0].checkState(file);    break;
+            case SECTION_TIMERS7:       valid = core->timers[1].checkState(file);    break;
+            default:                    valid = core->checkState(file);              break;
+        }
+        if (!valid) return false;
+    }
+
+    // Return to the start of the component data so it can be loaded
+    return !fseek(file, start, SEEK_SET);
+}
+
+StateResult SaveStates::loadState(FILE *file)
+{
+    // Verify the state header
+    char tag[8];
+    uint32_t version;
+    uint8_t gbaMode;
+    uint64_t size;
+    uint32_t offsets[SECTION_COUNT];
+    if (fread(tag, sizeof(char), 8, file) != 8 || memcmp(tag, stateTag, 8))
+        return STATE_FORMAT_FAIL;
+    if (fread(&version, sizeof(version), 1, file) != 1 || version != stateVersion)
+        return STATE_VERSION_FAIL;
+    if (fread(&gbaMode, sizeof(gbaMode), 1, file) != 1 || fread(&size, sizeof(size), 1, file) != 1 ||
+        fread(offsets, sizeof(uint32_t), SECTION_COUNT, file) != SECTION_COUNT)
+        return STATE_FORMAT_FAIL;
+
+    // There's no going back to NDS mode once GBA mode is entered
+    if (!gbaMode && core->gbaMode)
+        return STATE_FORMAT_FAIL;
+
+    // Make sure the component data is all there before touching anything
+    // States can be padded at the end, so only a short stream is rejected
+    long start = ftell(file);
+    if (start < 0 || fseek(file, 0, SEEK_END))
+        return STATE_FILE_FAIL;
+    long end = ftell(file);
+    if (end < start || (uint64_t)(end - start) < size || fseek(file, start, SEEK_SET))
+        return STATE_FILE_FAIL;
+
+    // Check the sizes, indices, and memory map settings of every component before loading any of them
+    if (!checkState(file, start, offsets, size))
+        return STATE_FORMAT_FAIL;
+
+    // Let the 3D renderer finish and drop any cached code, since the state they use is about to be replaced
+    core->gpu3DRenderer.joinThreads();
+    core->jit.flush();
+
+    // Load the 3D engine first, since it checks its own vertex indices and queue counts while reading
+    // It only replaces its state once everything it read is valid, so nothing has changed if it fails
+    if (!core->gpu3D.loadState(file))
+        return STATE_FORMAT_FAIL;
+
+    // Switch to GBA mode if the state needs it
+    if (gbaMode && !core->gbaMode)
+    {
+        core->enterGbaMode();
+        core->running.store(true);
+    }
+
+    // Read the state of every other component, which can't fail now that everything has been checked
+    // The CP15 is loaded before memory, since its TCM settings are needed to rebuild the memory maps
+    // The 3D renderer is loaded last, since it redraws the current frame using everything else
+    for (int i = 0; i < 3; i++)
+        core->bios[i].loadState(file);
+    core->cartridgeNds.loadState(file);
+    core->cartridgeGba.loadState(file);
+    core->cp15.loadState(file);
+    core->divSqrt.loadState(file);
+    for (int i = 0; i < 2; i++)
+        core->dma[i].loadState(file);
+    core->gpu.loadState(file);
+    for (int i = 0; i < 2; i++)
+        core->gpu2D[i].loadState(file);
+    for (int i = 0; i < 2; i++)
+        core->interpreter[i].loadState(file);
+    core->ipc.loadState(file);
+    core->memory.loadState(file);
+    core->rtc.loadState(file);
+    core->spi.loadState(file);
+    core->spu.loadState(file);
+    for (int i = 0; i < 2; i++)
+        core->timers[i].loadState(file);
+    core->wifi.loadState(file);
+    core->gpu3DRenderer.loadState(file);
+    core->loadState(file);
+    return (feof(file) || ferror(file)) ? STATE_FILE_FAIL : STATE_SUCCESS;
+}
@@ -0,0 +1,72 @@
+/*
+    Copyright 2019-2023 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef SAVE_STATES_H
+#define SAVE_STATES_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+class Core;
+
+enum StateResult
+{
+    STATE_SUCCESS = 0,
+    STATE_FILE_FAIL,
+    STATE_FORMAT_FAIL,
+    STATE_VERSION_FAIL
+};
+
+// Components with values that are checked before a state is loaded
+// The header stores where each of them starts, so they can be found without loading what comes before
+enum StateSection
+{
+    SECTION_CARTRIDGE_NDS = 0,
+    SECTION_CARTRIDGE_GBA,
+    SECTION_CP15,
+    SECTION_IPC,
+    SECTION_MEMORY,
+    SECTION_SPU,
+    SECTION_TIMERS9,
+    SECTION_TIMERS7,
+    SECTION_CORE,
+    SECTION_COUNT
+};
+
+class SaveStates
+{
+    public:
+        SaveStates(Core *core): core(core) {}
+
+        bool saveState(std::string path);
+        bool saveState(FILE *file);
+        StateResult loadState(std::string path);
+        StateResult loadState(FILE *file);
+
+    private:
+        Core *core;
+
+        static const char stateTag[8];
+        static const uint32_t stateVersion;
+
+        bool checkState(FILE *file, long start, uint32_t *offsets, uint64_t size);
+};
+
+#endif // SAVE_STATES_H
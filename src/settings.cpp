@@ -17,6 +17,8 @@
     along with NooDS. If not, see <https://www.gnu.org/licenses/>.
 */
 
+#include <algorithm>
+
 #include "settings.h"
 #include "defines.h"
 
@@ -24,7 +26,14 @@ int Settings::directBoot = 1;
 int Settings::fpsLimiter = 1;
 int Settings::threaded2D = 1;
 int Settings::threaded3D = 1;
+int Settings::threadedGeometry = 0;
+int Settings::tiled3D = 0;
 int Settings::highRes3D = 0;
+int Settings::scale3D = 2;
+int Settings::jit = 0;
+int Settings::rewind = 0;
+int Settings::rewindFrames = 10;
+int Settings::rewindMemory = 64;
 std::string Settings::bios9Path = "bios9.bin";
 std::string Settings::bios7Path = "bios7.bin";
 std::string Settings::firmwarePath = "firmware.bin";
@@ -35,16 +44,23 @@ std::string Settings::filename = "noods.ini";
 
 std::vector<Setting> Settings::settings =
 {
-    Setting("directBoot",   &directBoot,   false),
-    Setting("fpsLimiter",   &fpsLimiter,   false),
-    Setting("threaded2D",   &threaded2D,   false),
-    Setting("threaded3D",   &threaded3D,   false),
-    Setting("highRes3D",    &highRes3D,    false),
-    Setting("bios9Path",    &bios9Path,    true),
-    Setting("bios7Path",    &bios7Path,    true),
-    Setting("firmwarePath", &firmwarePath, true),
-    Setting("gbaBiosPath",  &gbaBiosPath,  true),
-    Setting("sdImagePath",  &sdImagePath,  true)
+    Setting("directBoot",       &directBoot,       false),
+    Setting("fpsLimiter",       &fpsLimiter,       false),
+    Setting("threaded2D",       &threaded2D,       false),
+    Setting("threaded3D",       &threaded3D,       false),
+    Setting("threadedGeometry", &threadedGeometry, false),
+    Setting("tiled3D",          &tiled3D,          false),
+    Setting("highRes3D",        &highRes3D,        false),
+    Setting("scale3D",          &scale3D,          false),
+    Setting("jit",              &jit,              false),
+    Setting("rewind",           &rewind,           false),
+    Setting("rewindFrames",     &rewindFrames,     false),
+    Setting("rewindMemory",     &rewindMemory,     false),
+    Setting("bios9Path",        &bios9Path,        true),
+    Setting("bios7Path",        &bios7Path,        true),
+    Setting("firmwarePath",     &firmwarePath,     true),
+    Setting("gbaBiosPath",      &gbaBiosPath,      true),
+    Setting("sdImagePath",      &sdImagePath,      true)
 };
 
 void Settings::add(std::vector<Setting> platformSettings)
@@ -104,3 +120,9 @@ bool Settings::save()
     fclose(settingsFile);
     return true;
 }
+
+int Settings::getScale3D()
+{
+    // Get the 3D resolution scale, which is only used when high-res 3D is enabled
+    return highRes3D ? std::min(std::max(scale3D, 1), 8) : 1;
+}
@@ -40,7 +40,14 @@ class Settings
         static int fpsLimiter;
         static int threaded2D;
         static int threaded3D;
+        static int threadedGeometry;
+        static int tiled3D;
         static int highRes3D;
+        static int scale3D;
+        static int jit;
+        static int rewind;
+        static int rewindFrames;
+        static int rewindMemory;
         static std::string bios9Path;
         static std::string bios7Path;
         static std::string firmwarePath;
@@ -51,6 +58,8 @@ class Settings
         static bool load(std::string filename = "noods.ini");
         static bool save();
 
+        static int getScale3D();
+
     private:
         static std::string filename;
         static std::vector<Setting> settings;
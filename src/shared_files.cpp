@@ -0,0 +1,49 @@
+/*
+    Copyright 2019-2023 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include <cstdio>
+
+#include "shared_files.h"
+
+const std::vector<uint8_t> *SharedFiles::get(std::string path)
+{
+    // Return the file's data if it was already requested, or null if it couldn't be shared then
+    std::lock_guard<std::mutex> guard(mutex);
+    std::map<std::string, std::unique_ptr<std::vector<uint8_t>>>::iterator it = files.find(path);
+    if (it != files.end())
+        return it->second.get();
+
+    // Load the file into memory the first time it's requested, remembering if it doesn't exist or is too large
+    std::unique_ptr<std::vector<uint8_t>> &data = files[path];
+    if (FILE *file = fopen(path.c_str(), "rb"))
+    {
+        fseek(file, 0, SEEK_END);
+        long size = ftell(file);
+        fseek(file, 0, SEEK_SET);
+        if (size >= 0 && size <= MAX_SIZE)
+        {
+            // Drop the data if the whole file couldn't be read
+            data.reset(new std::vector<uint8_t>(size));
+            if (fread(data->data(), sizeof(uint8_t), size, file) != (size_t)size)
+                data.reset();
+        }
+        fclose(file);
+    }
+    return data.get();
+}
@@ -0,0 +1,44 @@
+/*
+    Copyright 2019-2023 Hydr8gon
+
+    This file is part of NooDS.
+
+    NooDS is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    NooDS is distributed in the hope that it will be useful, but
+    WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+    General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with NooDS. If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef SHARED_FILES_H
+#define SHARED_FILES_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class SharedFiles
+{
+    public:
+        const std::vector<uint8_t> *get(std::string path);
+
+    private:
+        // Files larger than this aren't shared, so they can be loaded in sections like usual
+        static const long MAX_SIZE = 0x20000000; // 512MB
+
+
+        std::map<std::string, std::unique_ptr<std::vector<uint8_t>>> files;
+        std::mutex mutex;
+};
+
+#endif // SHARED_FILES_H
@@ -51,18 +51,34 @@ bool Spi::loadFirmware()
 {
     // Ensure firmware memory isn't already allocated
     if (firmware)
+    {
         delete[] firmware;
+        firmware = nullptr;
+    }
 
-    // Load the firmware from a file if it exists
-    if (FILE *file = fopen(Settings::firmwarePath.c_str(), "rb"))
+    if (core->sharedFiles)
+    {
+        // Copy the firmware from shared files if it exists; each core needs its own since it can be written
+        if (const std::vector<uint8_t> *data = core->sharedFiles->get(Settings::firmwarePath))
+        {
+            firmSize = data->size();
+            firmware = new uint8_t[firmSize];
+            memcpy(firmware, data->data(), firmSize);
+        }
+    }
+    else if (FILE *file = fopen(Settings::firmwarePath.c_str(), "rb"))
     {
+        // Load the firmware from a file if it exists
         fseek(file, 0, SEEK_END);
         firmSize = ftell(file);
         fseek(file, 0, SEEK_SET);
         firmware = new uint8_t[firmSize];
         fread(firmware, sizeof(uint8_t), firmSize, file);
         fclose(file);
+    }
 
+    if (firmware)
+    {
         if (core->id > 0)
         {
             // Increment the MAC address based on the instance ID
@@ -323,3 +339,23 @@ void Spi::writeSpiData(uint8_t value)
     if (spiCnt & BIT(14))
         core->interpreter[1].sendInterrupt(23);
 }
+
+void Spi::saveState(FILE *file)
+{
+    // Write state data to the file
+    fwrite(&writeCount, sizeof(writeCount), 1, file);
+    fwrite(&address, sizeof(address), 1, file);
+    fwrite(&command, sizeof(command), 1, file);
+    fwrite(&spiCnt, sizeof(spiCnt), 1, file);
+    fwrite(&spiData, sizeof(spiData), 1, file);
+}
+
+void Spi::loadState(FILE *file)
+{
+    // Read state data from the file
+    fread(&writeCount, sizeof(writeCount), 1, file);
+    fread(&address, sizeof(address), 1, file);
+    fread(&command, sizeof(command), 1, file);
+    fread(&spiCnt, sizeof(spiCnt), 1, file);
+    fread(&spiData, sizeof(spiData), 1, file);
+}
@@ -21,6 +21,7 @@
 #define SPI_H
 
 #include <cstdint>
+#include <cstdio>
 #include <mutex>
 
 enum Language
@@ -39,6 +40,9 @@ class Spi
 {
     public:
         Spi(Core *core): core(core) {}
+
+        void saveState(FILE *file);
+        void loadState(FILE *file);
         ~Spi();
 
         bool loadFirmware();
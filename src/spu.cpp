@@ -122,6 +122,9 @@ uint32_t *Spu::getSamples(int count)
 
 void Spu::runGbaSample()
 {
+    // Count sample generation as SPU time
+    BenchSection last = core->benchmark.setSection(BENCH_SPU);
+
     int64_t sampleLeft = 0;
     int64_t sampleRight = 0;
 
@@ -390,10 +393,14 @@ void Spu::runGbaSample()
 
     // Reschedule the task for the next sample
     core->schedule(GBA_SPU_SAMPLE, 512);
+    core->benchmark.setSection(last);
 }
 
 void Spu::runSample()
 {
+    // Count sample generation as SPU time
+    BenchSection last = core->benchmark.setSection(BENCH_SPU);
+
     int64_t mixerLeft = 0, mixerRight = 0;
     int64_t channelsLeft[2] = {}, channelsRight[2] = {};
 
@@ -693,6 +700,7 @@ void Spu::runSample()
 
     // Reschedule the task for the next sample
     core->schedule(NDS_SPU_SAMPLE, 512 * 2);
+    core->benchmark.setSection(last);
 }
 
 void Spu::swapBuffers()
@@ -1070,3 +1078,155 @@ uint8_t Spu::readGbaWaveRam(int index)
     // Read from the currently inactive GBA wave RAM bank
     return gbaWaveRam[!(gbaSoundCntL[1] & BIT(6))][index];
 }
+
+void Spu::saveState(FILE *file)
+{
+    // Write the GBA FIFOs to the file
+    std::queue<int8_t> fifos[2] = { gbaFifoA, gbaFifoB };
+    for (int i = 0; i < 2; i++)
+    {
+        uint8_t size = fifos[i].size();
+        fwrite(&size, sizeof(size), 1, file);
+        for (; !fifos[i].empty(); fifos[i].pop())
+            fwrite(&fifos[i].front(), sizeof(int8_t), 1, file);
+    }
+
+    // Write state data to the file
+    fwrite(&gbaFrameSequencer, sizeof(gbaFrameSequencer), 1, file);
+    fwrite(gbaSoundTimers, sizeof(gbaSoundTimers), 1, file);
+    fwrite(gbaEnvelopes, sizeof(gbaEnvelopes), 1, file);
+    fwrite(gbaEnvTimers, sizeof(gbaEnvTimers), 1, file);
+    fwrite(&gbaSweepTimer, sizeof(gbaSweepTimer), 1, file);
+    fwrite(&gbaWaveDigit, sizeof(gbaWaveDigit), 1, file);
+    fwrite(&gbaNoiseValue, sizeof(gbaNoiseValue), 1, file);
+    fwrite(gbaWaveRam, sizeof(gbaWaveRam), 1, file);
+    fwrite(&gbaSampleA, sizeof(gbaSampleA), 1, file);
+    fwrite(&gbaSampleB, sizeof(gbaSampleB), 1, file);
+    fwrite(&enabled, sizeof(enabled), 1, file);
+    fwrite(adpcmValue, sizeof(adpcmValue), 1, file);
+    fwrite(adpcmLoopValue, sizeof(adpcmLoopValue), 1, file);
+    fwrite(adpcmIndex, sizeof(adpcmIndex), 1, file);
+    fwrite(adpcmLoopIndex, sizeof(adpcmLoopIndex), 1, file);
+    fwrite(adpcmToggle, sizeof(adpcmToggle), 1, file);
+    fwrite(dutyCycles, sizeof(dutyCycles), 1, file);
+    fwrite(noiseValues, sizeof(noiseValues), 1, file);
+    fwrite(soundCurrent, sizeof(soundCurrent), 1, file);
+    fwrite(soundTimers, sizeof(soundTimers), 1, file);
+    fwrite(sndCapCurrent, sizeof(sndCapCurrent), 1, file);
+    fwrite(sndCapTimers, sizeof(sndCapTimers), 1, file);
+    fwrite(gbaSoundCntL, sizeof(gbaSoundCntL), 1, file);
+    fwrite(gbaSoundCntH, sizeof(gbaSoundCntH), 1, file);
+    fwrite(gbaSoundCntX, sizeof(gbaSoundCntX), 1, file);
+    fwrite(&gbaMainSoundCntL, sizeof(gbaMainSoundCntL), 1, file);
+    fwrite(&gbaMainSoundCntH, sizeof(gbaMainSoundCntH), 1, file);
+    fwrite(&gbaMainSoundCntX, sizeof(gbaMainSoundCntX), 1, file);
+    fwrite(&gbaSoundBias, sizeof(gbaSoundBias), 1, file);
+    fwrite(soundCnt, sizeof(soundCnt), 1, file);
+    fwrite(soundSad, sizeof(soundSad), 1, file);
+    fwrite(soundTmr, sizeof(soundTmr), 1, file);
+    fwrite(soundPnt, sizeof(soundPnt), 1, file);
+    fwrite(soundLen, sizeof(soundLen), 1, file);
+    fwrite(&mainSoundCnt, sizeof(mainSoundCnt), 1, file);
+    fwrite(&soundBias, sizeof(soundBias), 1, file);
+    fwrite(sndCapCnt, sizeof(sndCapCnt), 1, file);
+    fwrite(sndCapDad, sizeof(sndCapDad), 1, file);
+    fwrite(sndCapLen, sizeof(sndCapLen), 1, file);
+}
+
+void Spu::loadState(FILE *file)
+{
+    // Read the GBA FIFOs from the file
+    std::queue<int8_t> *fifos[2] = { &gbaFifoA, &gbaFifoB };
+    for (int i = 0; i < 2; i++)
+    {
+        uint8_t size = 0;
+        fread(&size, sizeof(size), 1, file);
+        *fifos[i] = std::queue<int8_t>();
+        for (int j = 0; j < size; j++)
+        {
+            int8_t sample = 0;
+            fread(&sample, sizeof(sample), 1, file);
+            fifos[i]->push(sample);
+        }
+    }
+
+    // Read state data from the file
+    fread(&gbaFrameSequencer, sizeof(gbaFrameSequencer), 1, file);
+    fread(gbaSoundTimers, sizeof(gbaSoundTimers), 1, file);
+    fread(gbaEnvelopes, sizeof(gbaEnvelopes), 1, file);
+    fread(gbaEnvTimers, sizeof(gbaEnvTimers), 1, file);
+    fread(&gbaSweepTimer, sizeof(gbaSweepTimer), 1, file);
+    fread(&gbaWaveDigit, sizeof(gbaWaveDigit), 1, file);
+    fread(&gbaNoiseValue, sizeof(gbaNoiseValue), 1, file);
+    fread(gbaWaveRam, sizeof(gbaWaveRam), 1, file);
+    fread(&gbaSampleA, sizeof(gbaSampleA), 1, file);
+    fread(&gbaSampleB, sizeof(gbaSampleB), 1, file);
+    fread(&enabled, sizeof(enabled), 1, file);
+    fread(adpcmValue, sizeof(adpcmValue), 1, file);
+    fread(adpcmLoopValue, sizeof(adpcmLoopValue), 1, file);
+    fread(adpcmIndex, sizeof(adpcmIndex), 1, file);
+    fread(adpcmLoopIndex, sizeof(adpcmLoopIndex), 1, file);
+    fread(adpcmToggle, sizeof(adpcmToggle), 1, file);
+    fread(dutyCycles, sizeof(dutyCycles), 1, file);
+    fread(noiseValues, sizeof(noiseValues), 1, file);
+    fread(soundCurrent, sizeof(soundCurrent), 1, file);
+    fread(soundTimers, sizeof(soundTimers), 1, file);
+    fread(sndCapCurrent, sizeof(sndCapCurrent), 1, file);
+    fread(sndCapTimers, sizeof(sndCapTimers), 1, file);
+    fread(gbaSoundCntL, sizeof(gbaSoundCntL), 1, file);
+    fread(gbaSoundCntH, sizeof(gbaSoundCntH), 1, file);
+    fread(gbaSoundCntX, sizeof(gbaSoundCntX), 1, file);
+    fread(&gbaMainSoundCntL, sizeof(gbaMainSoundCntL), 1, file);
+    fread(&gbaMainSoundCntH, sizeof(gbaMainSoundCntH), 1, file);
+    fread(&gbaMainSoundCntX, sizeof(gbaMainSoundCntX), 1, file);
+    fread(&gbaSoundBias, sizeof(gbaSoundBias), 1, file);
+    fread(soundCnt, sizeof(soundCnt), 1, file);
+    fread(soundSad, sizeof(soundSad), 1, file);
+    fread(soundTmr, sizeof(soundTmr), 1, file);
+    fread(soundPnt, sizeof(soundPnt), 1, file);
+    fread(soundLen, sizeof(soundLen), 1, file);
+    fread(&mainSoundCnt, sizeof(mainSoundCnt), 1, file);
+    fread(&soundBias, sizeof(soundBias), 1, file);
+    fread(sndCapCnt, sizeof(sndCapCnt), 1, file);
+    fread(sndCapDad, sizeof(sndCapDad), 1, file);
+    fread(sndCapLen, sizeof(sndCapLen), 1, file);
+}
+
+bool Spu::checkState(FILE *file)
+{
+    // Check that the GBA FIFOs aren't bigger than the 32 samples they can hold
+    for (int i = 0; i < 2; i++)
+    {
+        uint8_t size = 0;
+        if (fread(&size, sizeof(size), 1, file) != 1 || size > 32)
+            return false;
+        fseek(file, size * sizeof(int8_t), SEEK_CUR);
+    }
+
+    // Skip to the wave position, which is used to index wave RAM
+    int waveDigit;
+    fseek(file, sizeof(gbaFrameSequencer) + sizeof(gbaSoundTimers) + sizeof(gbaEnvelopes) +
+        sizeof(gbaEnvTimers) + sizeof(gbaSweepTimer), SEEK_CUR);
+    if (fread(&waveDigit, sizeof(waveDigit), 1, file) != 1 || waveDigit < 0 || waveDigit > 63)
+        return false;
+
+    // Skip to the ADPCM indices, which are used to index the ADPCM table
+    int indices[32];
+    fseek(file, sizeof(gbaNoiseValue) + sizeof(gbaWaveRam) + sizeof(gbaSampleA) + sizeof(gbaSampleB) +
+        sizeof(enabled) + sizeof(adpcmValue) + sizeof(adpcmLoopValue), SEEK_CUR);
+    if (fread(indices, sizeof(int), 32, file) != 32)
+        return false;
+    for (int i = 0; i < 32; i++)
+        if (indices[i] < 0 || indices[i] > 88)
+            return false;
+
+    // Skip to the duty cycle positions, which are compared against the duty setting
+    int duties[6];
+    fseek(file, sizeof(adpcmToggle), SEEK_CUR);
+    if (fread(duties, sizeof(int), 6, file) != 6)
+        return false;
+    for (int i = 0; i < 6; i++)
+        if (duties[i] < 0 || duties[i] > 7)
+            return false;
+    return true;
+}
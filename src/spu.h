@@ -23,6 +23,7 @@
 #include <atomic>
 #include <condition_variable>
 #include <cstdint>
+#include <cstdio>
 #include <queue>
 #include <mutex>
 
@@ -34,6 +35,11 @@ class Spu
         Spu(Core *core);
         ~Spu();
 
+        void saveState(FILE *file);
+        void loadState(FILE *file);
+        bool checkState(FILE *file);
+
+        bool isReady() { return ready.load(); }
         uint32_t *getSamples(int count);
         void runGbaSample();
         void runSample();
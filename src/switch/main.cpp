@@ -625,6 +625,10 @@ int main(int argc, char **argv)
     ScreenLayout::addSettings();
     Settings::add(platformSettings);
     if (!Settings::load()) Settings::save();
+
+    // The framebuffer is only sized for 2x high-res 3D, so don't allow other scales
+    Settings::scale3D = 2;
+
     layout.update(1280, 720, gbaMode);
 
     // Get the system language
@@ -100,6 +100,11 @@ void Timers::writeTmCntH(int timer, uint16_t mask, uint16_t value)
         core->schedule(SchedTask(TIMER9_OVERFLOW0 + (cpu << 2) + timer), (0x10000 - timers[timer]) << shifts[timer]);
         endCycles[timer] = core->globalCycles + ((0x10000 - timers[timer]) << shifts[timer]);
     }
+    else if (!(tmCntH[timer] & BIT(7)) || (timer != 0 && (tmCntH[timer] & BIT(2))))
+    {
+        // Cancel any pending overflow if the timer was stopped or switched to count-up mode
+        core->unschedule(SchedTask(TIMER9_OVERFLOW0 + (cpu << 2) + timer));
+    }
 }
 
 uint16_t Timers::readTmCntL(int timer)
@@ -109,3 +114,36 @@ uint16_t Timers::readTmCntL(int timer)
         timers[timer] = 0x10000 - ((endCycles[timer] - core->globalCycles) >> shifts[timer]);
     return timers[timer];
 }
+
+void Timers::saveState(FILE *file)
+{
+    // Write state data to the file
+    fwrite(timers, sizeof(timers), 1, file);
+    fwrite(shifts, sizeof(shifts), 1, file);
+    fwrite(endCycles, sizeof(endCycles), 1, file);
+    fwrite(tmCntL, sizeof(tmCntL), 1, file);
+    fwrite(tmCntH, sizeof(tmCntH), 1, file);
+}
+
+void Timers::loadState(FILE *file)
+{
+    // Read state data from the file
+    fread(timers, sizeof(timers), 1, file);
+    fread(shifts, sizeof(shifts), 1, file);
+    fread(endCycles, sizeof(endCycles), 1, file);
+    fread(tmCntL, sizeof(tmCntL), 1, file);
+    fread(tmCntH, sizeof(tmCntH), 1, file);
+}
+
+bool Timers::checkState(FILE *file)
+{
+    // Skip to the prescaler shifts, and check that they're ones the timers can use
+    uint8_t values[4];
+    fseek(file, sizeof(timers), SEEK_CUR);
+    if (fread(values, sizeof(uint8_t), 4, file) != 4)
+        return false;
+    for (int i = 0; i < 4; i++)
+        if (values[i] != 0 && values[i] != 6 && values[i] != 8 && values[i] != 10)
+            return false;
+    return true;
+}
@@ -21,6 +21,7 @@
 #define TIMERS_H
 
 #include <cstdint>
+#include <cstdio>
 
 class Core;
 
@@ -29,6 +30,10 @@ class Timers
     public:
         Timers(Core *core, bool cpu): core(core), cpu(cpu) {}
 
+        void saveState(FILE *file);
+        void loadState(FILE *file);
+        bool checkState(FILE *file);
+
         void resetCycles();
         void overflow(int timer);
 
@@ -696,6 +696,9 @@ int main()
         Settings::save();
     }
 
+    // The framebuffer is only sized for 2x high-res 3D, so don't allow other scales
+    Settings::scale3D = 2;
+
     // Set the cancel and confirm buttons based on the system registry value
     int assign;
     sceRegMgrGetKeyInt("/CONFIG/SYSTEM", "button_assign", &assign);
@@ -21,6 +21,7 @@
 #define WIFI_H
 
 #include <cstdint>
+#include <cstdio>
 #include <mutex>
 #include <vector>
 
@@ -31,6 +32,9 @@ class Wifi
     public:
         Wifi(Core *core);
 
+        void saveState(FILE *file);
+        void loadState(FILE *file);
+
         void addConnection(Core *core);
         void remConnection(Core *core);
 
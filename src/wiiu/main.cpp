@@ -148,6 +148,9 @@ int main()
         Settings::save();
     }
 
+    // The framebuffer is only sized for 2x high-res 3D, so don't allow other scales
+    Settings::scale3D = 2;
+
     // Get the current TV render dimensions
     int tvWidth, tvHeight;
     switch (GX2GetSystemTVScanMode())